@@ -0,0 +1,38 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cell_codec.hpp"
+#include "colour.hpp"
+#include "frame_encoder.hpp"
+#include "kernels.hpp"
+#include "optimiser.hpp"
+#include "worker_pool.hpp"
+
+// pixels per benchmark pass, roughly a 1080p frame, and passes per measurement
+#define BENCHMARK_PIXELS (1920 * 1080)
+#define BENCHMARK_PASSES 20
+
+// terminal size in cells the frame encoder is timed on
+#define BENCHMARK_TERM_WIDTH 320
+#define BENCHMARK_TERM_HEIGHT 100
+
+// size in cells & length of the clip exported with compressed cells, a keyframe is
+// stored every BENCHMARK_CLIP_KEYFRAMES frames like a 30fps export
+#define BENCHMARK_CLIP_WIDTH 120
+#define BENCHMARK_CLIP_HEIGHT 40
+#define BENCHMARK_CLIP_FRAMES 120
+#define BENCHMARK_CLIP_KEYFRAMES 60
+
+namespace TermVideo
+{
+    void run_benchmark();
+}
+
+#endif
\ No newline at end of file
@@ -9,6 +9,8 @@
 #include <thread>
 #include <vector>
 
+#include "cell.hpp"
+#include "frame_encoder.hpp"
 #include "optimiser.hpp"
 #include "options.hpp"
 #include "performance_checker.hpp"
@@ -28,6 +30,10 @@ typedef unsigned long ULONG;
 typedef unsigned char uchar;
 typedef unsigned short WORD;
 
+// colour pairs usable by ncurses output, a chtype holds pair numbers up to 255 and
+// pair 0 is the terminal's default colours
+#define CURSES_MAX_PAIRS 255
+
 namespace TermVideo
 {
     class BufferRenderer : public Renderer
@@ -38,15 +44,19 @@ namespace TermVideo
         void init_renderer() override;
         void start_renderer() override;
 
+    protected:
+        void present_frame(VideoFrame &) override;
+
     private:
-        void frame_to_ascii(uchar *, const int, const int, const int);
+        void frame_to_ascii(const VideoFrame &);
         void write_to_buffer(const int, const int, uchar, WORD);
-        void check_resize();
+        void check_resize(const VideoFrame &);
+        void resize_buffer(const int, const int);
+
+        int buffer_width, buffer_height;
 
 #if defined(__USE_OPENCV)
         void process_video_opencv();
-#elif defined(__USE_FFMPEG)
-        void process_video_ffmpeg();
 #endif
 
 #if defined(_WIN32)
@@ -57,8 +67,18 @@ namespace TermVideo
 #elif defined(__linux__)
         void set_curses_colors();
 
-        // how many steps does each colour take in init_color
-        short color_step_no;
+        // without ncurses, the renderer's cells are the back buffer and the frame encoder's
+        // screen the front buffer, only the cells that differ are written
+        bool use_curses;
+
+        // RGB of each initialised colour pair from pair 1, packed 3 bytes per pair, the
+        // pair nearest to every 15 bit RGB value and the levels per channel to dither to
+        std::vector<uchar> pair_colours, pair_lut;
+        int colour_levels;
+        std::vector<uchar> dither_pixels;
+
+        // row of attributed characters written to the screen in a single call
+        std::vector<chtype> row_chars;
 #endif
     };
 }
@@ -0,0 +1,67 @@
+#ifndef CAST_WRITER_H
+#define CAST_WRITER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// events waiting for the writer thread, the presenter only waits once this much is
+// queued, which only happens when the disk can't keep up
+#define CAST_MAX_PENDING_BYTES (32 << 20)
+
+// stdio buffer of the .cast file
+#define CAST_WRITE_BUFFER (1 << 20)
+
+typedef unsigned char uchar;
+
+namespace TermVideo
+{
+    /**
+     * @brief Streams an asciinema v2 recording to a .cast file. Events are queued as raw
+     *        bytes and escaped into JSON lines on a background thread, so adding an event
+     *        is a single copy for the caller
+     */
+    class CastWriter
+    {
+    public:
+        CastWriter();
+        ~CastWriter();
+        CastWriter(const CastWriter &) = delete;
+        CastWriter &operator=(const CastWriter &) = delete;
+
+        std::string open(const std::string &, int, int, const std::string &);
+        void add_output(double, const std::string &);
+        void add_resize(double, int, int);
+        std::string close();
+        uint64_t get_event_count();
+        uint64_t get_stalls();
+
+    private:
+        FILE *file;
+        std::thread thread;
+        std::mutex mutex;
+        std::condition_variable cond;
+
+        // queued events, each the time in milliseconds, the event type, the length of the
+        // data and the data. The writer thread swaps them out into writing
+        std::string pending, writing;
+        std::string line;
+        bool closing;
+        bool write_failed;
+        uint64_t events;
+        uint64_t stalls;
+
+        void add_event(double, char, const char *, size_t);
+        void write_events();
+        void write_line(double, char, const char *, size_t);
+    };
+
+    void append_json_string(std::string &, const char *, size_t);
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,25 @@
+#ifndef CELL_H
+#define CELL_H
+
+#include <cstdint>
+
+typedef unsigned char uchar;
+
+namespace TermVideo
+{
+    /**
+     * @brief A single terminal cell, the glyph is a unicode code point. In 256 & 16 colour
+     *        output, colour & bg_colour hold the palette indices of the RGB values.
+     *        The background is only drawn when the encoder uses backgrounds
+     */
+    struct Cell
+    {
+        uint32_t glyph;
+        uchar r, g, b;
+        uchar colour;
+        uchar bg_r, bg_g, bg_b;
+        uchar bg_colour;
+    };
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,49 @@
+#ifndef CELL_CODEC_H
+#define CELL_CODEC_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "cell.hpp"
+
+typedef unsigned char uchar;
+
+namespace TermVideo
+{
+    /**
+     * @brief Compresses frames of cells for exported video. A frame is a series of operations
+     *        over the grid in order, each a varint of the cell count shifted left by 1 with
+     *        the operation in the low bit: 0 keeps the cells of the previous frame, 1 fills
+     *        them with the cell that follows. Keyframes only fill, so they decode on their own.
+     *        Cells within the colour threshold of the previous frame or of a run are treated
+     *        as the same, the encoder tracks what the decoder ends up with so errors don't build up
+     */
+    class CellCodec
+    {
+    public:
+        CellCodec();
+        CellCodec(bool, bool, uchar);
+        void encode(const std::vector<Cell> &, const int, const int, const bool, std::string &);
+        bool decode(const char *, size_t, const int, const int);
+        const std::vector<Cell> &get_cells();
+
+    private:
+        bool print_colour;
+        bool use_background;
+        uchar col_threshold;
+
+        // cells the decoder has after the last frame
+        std::vector<Cell> cells;
+
+        bool is_same_cell(const Cell &, const Cell &);
+        void append_cell(std::string &, const Cell &);
+        bool read_cell(const uchar *&, const uchar *, Cell &);
+    };
+
+    void append_varint(std::string &, uint64_t);
+    bool read_varint(const uchar *&, const uchar *, uint64_t &);
+}
+
+#endif
\ No newline at end of file
@@ -18,12 +18,28 @@
 typedef unsigned char uchar;
 typedef unsigned short WORD;
 
+// palette lookup tables are indexed by RGB truncated to 5 bits per channel
+#define PALETTE_LUT_BITS 5
+
 namespace TermVideo
 {
     uchar get_luminance_approximate(uchar, uchar, uchar, bool);
     WORD get_win32_col(uchar, uchar, uchar);
     int get_ncurses_col_index(uchar, uchar, uchar, short);
     std::string get_char_ansi_col(uchar, uchar, uchar, std::string);
+    uchar get_xterm256_index(uchar, uchar, uchar);
+    uchar get_ansi16_index(uchar, uchar, uchar);
+    const uchar *get_palette_colour(uchar, int);
+    std::vector<uchar> build_colour_pair_lut(const std::vector<uchar> &);
+
+    /**
+     * @brief Index of an RGB colour into a palette lookup table
+     */
+    inline int get_palette_lut_index(uchar r, uchar g, uchar b)
+    {
+        const int shift = 8 - PALETTE_LUT_BITS;
+        return ((r >> shift) << (2 * PALETTE_LUT_BITS)) | ((g >> shift) << PALETTE_LUT_BITS) | (b >> shift);
+    }
 }
 
 #endif
\ No newline at end of file
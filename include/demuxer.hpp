@@ -0,0 +1,73 @@
+#ifndef DEMUXER_H
+#define DEMUXER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "media.hpp"
+
+extern "C"
+{
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+}
+
+// demuxing pauses once every routed stream has at least this many packets waiting
+#define PACKET_QUEUE_SOFT_LIMIT 64
+
+namespace TermVideo
+{
+    /**
+     * @brief Packets of a single stream waiting to be decoded. Flushing bumps the serial
+     *        so the decoder knows to drop its state after a seek
+     */
+    class PacketQueue
+    {
+    public:
+        PacketQueue();
+        ~PacketQueue();
+        void put(AVPacket *);
+        int get(AVPacket *, int &);
+        void flush();
+        void close();
+        size_t size();
+        int get_serial();
+
+    private:
+        std::deque<AVPacket *> packets;
+        std::mutex mutex;
+        std::condition_variable cond;
+        std::atomic<int> serial;
+        bool closed;
+    };
+
+    /**
+     * @brief Owns the only AVFormatContext for the file and routes its packets to the
+     *        audio & video packet queues, so every packet is read and parsed once
+     */
+    class Demuxer
+    {
+    public:
+        Demuxer(MediaInfo *);
+        ~Demuxer();
+        std::string open_file(std::string);
+        void init_queues();
+        void demux();
+        void stop();
+
+    private:
+        MediaInfo *info;
+        std::atomic<bool> stopped;
+
+        void seek(Seek);
+        bool queues_full();
+        void close_queues();
+    };
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,59 @@
+#ifndef DITHER_H
+#define DITHER_H
+
+#include <algorithm>
+#include <array>
+#include <string>
+#include <vector>
+
+#include "colour.hpp"
+#include "kernels.hpp"
+
+typedef unsigned char uchar;
+
+// side of the ordered dithering threshold matrix
+#define BAYER_SIZE 8
+
+namespace TermVideo
+{
+    enum class DitherMode
+    {
+        None,
+        Bayer,
+        FloydSteinberg
+    };
+
+    /**
+     * @brief Spreads the error of quantising to a few levels or a small palette, either with
+     *        an ordered Bayer pattern or by Floyd-Steinberg error diffusion. Rows are passed
+     *        in one at a time from the top, error diffusion only keeps the errors of the
+     *        current & next row
+     */
+    class Ditherer
+    {
+    public:
+        Ditherer();
+        static bool is_valid_mode(std::string);
+        void set_mode(std::string);
+        bool is_enabled();
+        void dither_levels(uchar *, int, int, int, int);
+        void dither_palette(uchar *, int, int, int, uchar *);
+
+    private:
+        DitherMode mode;
+
+        // offsets of the Bayer pattern for every row of the matrix, split into the
+        // positive & negative parts, and what they were built for
+        std::vector<uchar> bayer_add, bayer_sub;
+        int bayer_length, bayer_channels, bayer_amplitude;
+
+        // errors carried into the current & next row, scaled by 16
+        std::array<std::vector<int>, 2> errors;
+        int last_row;
+
+        void build_bayer_rows(int, int, int);
+        void prepare_errors(int, int);
+    };
+}
+
+#endif
\ No newline at end of file
@@ -2,11 +2,62 @@
 #define EXPORT_H
 
 #include <fstream>
+#include <iostream>
 #include <string>
 
+#include "cell_codec.hpp"
+#include "options.hpp"
+#include "renderer.hpp"
+#include "tvid.hpp"
+
+// grid size of headless recordings when --grid-size isn't given
+#define HEADLESS_DEFAULT_WIDTH 80
+#define HEADLESS_DEFAULT_HEIGHT 24
+
 namespace TermVideo
 {
     void save_ascii_to_file(const std::string, const std::string);
+
+    /**
+     * @brief Renders a whole video at a fixed grid size into a .tvid file instead of the
+     *        terminal, as fast as it can be decoded
+     */
+    class ExportRenderer : public Renderer
+    {
+    public:
+        ExportRenderer(MediaInfo *, Options);
+        void init_renderer() override;
+        void start_renderer() override;
+
+    protected:
+        void present_frame(VideoFrame &) override;
+
+    private:
+        TvidWriter tvid;
+        CellCodec codec;
+        std::string export_path;
+        std::string dither;
+        bool compress;
+        bool use_background;
+        int grid_width, grid_height;
+        double last_keyframe_ms;
+        bool write_failed;
+    };
+
+    /**
+     * @brief Renders a whole video at a fixed grid size into an asciinema recording without
+     *        a terminal, as fast as it can be decoded
+     */
+    class HeadlessRenderer : public Renderer
+    {
+    public:
+        HeadlessRenderer(MediaInfo *, Options);
+        void init_renderer() override;
+        void start_renderer() override;
+
+    protected:
+        void present_frame(VideoFrame &) override;
+    };
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,121 @@
+#ifndef FRAME_ENCODER_H
+#define FRAME_ENCODER_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "cell.hpp"
+#include "colour.hpp"
+#include "dither.hpp"
+#include "kernels.hpp"
+#include "optimiser.hpp"
+#include "worker_pool.hpp"
+
+typedef unsigned char uchar;
+
+// unchanged cells between 2 changed runs are rewritten instead of repositioning the
+// cursor when the gap is at most this long, a cursor move costs up to 10 bytes
+#define DELTA_MERGE_GAP 4
+
+// longest bytes written for a single cell, a cursor move, foreground & background
+// colours and the glyph. Used to size the output buffer up front
+#define CURSOR_ESCAPE_MAX 14
+#define COLOUR_ESCAPE_MAX 19
+#define GLYPH_MAX_BYTES 4
+
+// rows of cells encoded together, bands are encoded in parallel. Fixed so the output
+// doesn't depend on the number of threads
+#define ENCODE_BAND_ROWS 8
+
+namespace TermVideo
+{
+    /**
+     * @brief Output & terminal state of a band of rows. Every band starts with the terminal's
+     *        colours unknown, so bands are encoded independently of each other
+     */
+    struct EncoderBand
+    {
+        std::string output;
+        Optimiser optimiser;
+
+        // terminal's colours, pen_colour & pen_bg_colour are palette indices in 256 & 16
+        // colour output, -1 until a colour has been set
+        Cell pen;
+        int pen_colour, pen_bg_colour;
+
+        // RGB foregrounds of the row being compared against the screen, and the changed cells
+        std::vector<uchar> row_rgb, row_changed;
+
+        size_t last_full_bytes;
+        bool repainted;
+    };
+
+    /**
+     * @brief Turns a grid of cells into the bytes written to the terminal. Keeps track of
+     *        what's currently on screen so only changed runs of cells need to be redrawn
+     */
+    class FrameEncoder
+    {
+    public:
+        FrameEncoder();
+        FrameEncoder(bool, uchar, bool, int, bool, int, std::string);
+        void encode(std::vector<Cell> &, const int, const int, std::string &);
+        void set_colour_threshold(uchar);
+        void set_colour_depth(int);
+        void set_worker_pool(WorkerPool *);
+        void force_full_repaint();
+        uint64_t get_full_frames();
+        uint64_t get_delta_frames();
+        bool is_budget_used();
+        double get_avg_budget_bytes_saved();
+        double get_mean_budget_error();
+
+    private:
+        BudgetOptimiser budget_optimiser;
+        Ditherer fg_ditherer, bg_ditherer;
+        bool print_colour;
+        bool use_delta;
+        bool use_background;
+        bool use_budget;
+        bool full_repaint;
+        uchar col_threshold;
+        int colour_depth;
+
+        // cells currently on screen, and their RGB foregrounds packed as BGR24
+        std::vector<Cell> screen;
+        int screen_width, screen_height;
+        std::vector<uchar> screen_rgb;
+
+        // row being quantised, as BGR24 & palette indices
+        std::vector<uchar> row_rgb, row_palette;
+
+        std::vector<EncoderBand> bands;
+        WorkerPool *worker_pool;
+        uint64_t full_frames, delta_frames;
+
+        void quantise(std::vector<Cell> &, const int, const int);
+        void encode_band(const std::vector<Cell> &, const int, const bool);
+        void reset_pen(EncoderBand &);
+        void encode_full(EncoderBand &, const std::vector<Cell> &, const int, const int);
+        bool encode_delta(EncoderBand &, const std::vector<Cell> &, const int, const int);
+        bool encode_cells(EncoderBand &, const std::vector<Cell> &, const int, const int, const int, const bool, bool);
+        void encode_cell(EncoderBand &, const Cell &, const int);
+        void apply_colours(EncoderBand &, const Cell &);
+        void record_cell(EncoderBand &, const Cell &, const int);
+        void find_changed_cells(EncoderBand &, const Cell *, const int, const int);
+        bool is_changed(const Cell &, const Cell &, bool);
+        bool is_same_blank(const Cell &, const Cell &);
+        bool is_colour_changed(uchar, uchar, uchar, uchar, uchar, uchar);
+    };
+
+    void append_glyph(std::string &, uint32_t);
+    int decimal_length(int);
+    void append_decimal(std::string &, int);
+    void append_cursor(std::string &, int, int);
+    void append_rgb_colour(std::string &, uchar, uchar, uchar, bool);
+    void append_palette_colour(std::string &, uchar, int, bool);
+}
+
+#endif
\ No newline at end of file
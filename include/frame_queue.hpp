@@ -0,0 +1,143 @@
+#ifndef FRAME_QUEUE_H
+#define FRAME_QUEUE_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace TermVideo
+{
+    /**
+     * @brief Bounded single-producer/single-consumer ring of preallocated slots.
+     *        The producer fills a slot in place and publishes it, the consumer reads it
+     *        in place and releases it, so frames are never copied between threads.
+     *
+     * @tparam T Slot type
+     */
+    template <typename T>
+    class FrameQueue
+    {
+    public:
+        FrameQueue(size_t capacity)
+            : slots(capacity),
+              head(0),
+              tail(0),
+              closed(false),
+              producer_stalls(0),
+              consumer_stalls(0),
+              depth_total(0),
+              depth_samples(0)
+        {
+        }
+
+        /**
+         * @brief Waits for a free slot to write into
+         * @return T* Slot to fill, nullptr if the queue has been closed
+         */
+        T *begin_write()
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            if (this->head - this->tail == this->slots.size())
+                this->producer_stalls++;
+
+            this->cond.wait(lock, [this]
+                            { return this->closed || this->head - this->tail < this->slots.size(); });
+            if (this->closed)
+                return nullptr;
+
+            return &this->slots[this->head % this->slots.size()];
+        }
+
+        /**
+         * @brief Publishes the slot returned by begin_write to the consumer
+         */
+        void end_write()
+        {
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                this->head++;
+            }
+            this->cond.notify_all();
+        }
+
+        /**
+         * @brief Waits for the oldest published slot
+         * @return T* Slot to read, nullptr once the queue is closed and drained
+         */
+        T *begin_read()
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            if (this->head == this->tail && !this->closed)
+                this->consumer_stalls++;
+
+            this->cond.wait(lock, [this]
+                            { return this->closed || this->head != this->tail; });
+            if (this->head == this->tail)
+                return nullptr;
+
+            this->depth_total += this->head - this->tail;
+            this->depth_samples++;
+            return &this->slots[this->tail % this->slots.size()];
+        }
+
+        /**
+         * @brief Hands the slot returned by begin_read back to the producer
+         */
+        void end_read()
+        {
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                this->tail++;
+            }
+            this->cond.notify_all();
+        }
+
+        /**
+         * @brief Wakes up both sides, the producer stops and the consumer drains what's left
+         */
+        void close()
+        {
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                this->closed = true;
+            }
+            this->cond.notify_all();
+        }
+
+        std::vector<T> &get_slots() { return this->slots; }
+        size_t get_capacity() const { return this->slots.size(); }
+
+        /**
+         * @brief Times the producer found the queue full, i.e. output is the bottleneck
+         */
+        uint64_t get_producer_stalls() const { return this->producer_stalls; }
+
+        /**
+         * @brief Times the consumer found the queue empty, i.e. decoding is the bottleneck
+         */
+        uint64_t get_consumer_stalls() const { return this->consumer_stalls; }
+
+        /**
+         * @brief Average number of ready slots seen by the consumer
+         */
+        double get_avg_depth() const
+        {
+            if (this->depth_samples == 0)
+                return 0;
+            return static_cast<double>(this->depth_total) / this->depth_samples;
+        }
+
+    private:
+        std::vector<T> slots;
+        std::mutex mutex;
+        std::condition_variable cond;
+        uint64_t head, tail;
+        bool closed;
+
+        uint64_t producer_stalls, consumer_stalls;
+        uint64_t depth_total, depth_samples;
+    };
+}
+
+#endif
\ No newline at end of file
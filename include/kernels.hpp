@@ -0,0 +1,63 @@
+#ifndef KERNELS_H
+#define KERNELS_H
+
+#include <cstdint>
+#include <vector>
+
+typedef unsigned char uchar;
+
+// integer luminance weights out of 256, Rec. 709 relative luminance and the plain average
+#define LUMA_WEIGHT_R 54
+#define LUMA_WEIGHT_G 183
+#define LUMA_WEIGHT_B 19
+#define AVG_WEIGHT_R 85
+#define AVG_WEIGHT_G 86
+#define AVG_WEIGHT_B 85
+
+namespace TermVideo
+{
+    /**
+     * @brief Row kernels working on packed BGR24 pixels. Every implementation produces the
+     *        same output as the scalar one, the fastest supported by the CPU is picked at runtime
+     */
+    struct Kernels
+    {
+        const char *name;
+
+        /**
+         * @brief Luminance of a row of pixels, also the glyph index into a luminance lookup table
+         * @param bgr Packed BGR24 pixels
+         * @param luminance Output luminance per pixel
+         * @param count Number of pixels
+         * @param force_avg_luminance Use the average of the RGB values instead of relative luminance
+         */
+        void (*luminance_row)(const uchar *bgr, uchar *luminance, int count, bool force_avg_luminance);
+
+        /**
+         * @brief Flags pixels whose colour differs from a reference row by more than a threshold
+         *        in any channel
+         * @param bgr Packed BGR24 pixels
+         * @param ref_bgr Packed BGR24 pixels to compare against
+         * @param count Number of pixels
+         * @param threshold Largest difference per channel still considered the same colour
+         * @param changed Output 1 for changed pixels, 0 otherwise
+         */
+        void (*colour_changed_row)(const uchar *bgr, const uchar *ref_bgr, int count, uchar threshold, uchar *changed);
+
+        /**
+         * @brief Adds signed offsets to bytes, clamped to 0-255. Each offset is split into
+         *        the amount added and the amount subtracted so it's branch free
+         * @param values Input bytes
+         * @param add Amount added to each byte
+         * @param sub Amount subtracted from each byte
+         * @param count Number of bytes
+         * @param out Output bytes, can be the same as values
+         */
+        void (*offset_row)(const uchar *values, const uchar *add, const uchar *sub, int count, uchar *out);
+    };
+
+    const Kernels &get_kernels();
+    std::vector<const Kernels *> get_supported_kernels();
+}
+
+#endif
\ No newline at end of file
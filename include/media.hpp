@@ -16,6 +16,8 @@ extern "C"
 
 namespace TermVideo
 {
+    class PacketQueue;
+
     struct Seek
     {
         double pos;
@@ -31,21 +33,22 @@ namespace TermVideo
         int seek_step_ms;
         std::string file_path;
 
+        // shared by both streams, owned by the Demuxer
+        Seek seek;
+        AVFormatContext *format_ctx;
+
         double v_clock_ms;
-        Seek v_seek;
-        AVFormatContext *v_format_ctx;
         const AVCodec *v_decoder;
         AVStream *v_stream;
         AVCodecContext *v_codec_ctx;
-        SwsContext *v_sws_ctx;
+        PacketQueue *v_packets;
 
         double a_clock_ms;
-        Seek a_seek;
-        AVFormatContext *a_format_ctx;
         const AVCodec *a_decoder;
         AVStream *a_stream;
         AVCodecContext *a_codec_ctx;
         SwrContext *a_swr_ctx;
+        PacketQueue *a_packets;
     };
 }
 
@@ -5,8 +5,11 @@
 
 #include "audio_player.hpp"
 #include "buffer_renderer.hpp"
+#include "demuxer.hpp"
+#include "export.hpp"
 #include "media.hpp"
 #include "renderer.hpp"
+#include "tvid_player.hpp"
 
 namespace TermVideo
 {
@@ -15,8 +18,10 @@ namespace TermVideo
     private:
         int seek_step_ms;
         MediaInfo *info;
+        Demuxer *demuxer;
         AudioPlayer *audio_player;
         Renderer *renderer;
+        TvidPlayer *tvid_player;
 
     public:
         MediaPlayer();
@@ -1,11 +1,28 @@
 #ifndef OPTIMISER_H
 #define OPTIMISER_H
 
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
 #include <iostream>
 #include <stdlib.h>
+#include <vector>
+
+#include "cell.hpp"
 
 typedef unsigned char uchar;
 
+// weights of the perceptual colour distance, green differences are the most visible
+// and blue the least. A grey shift of n in every channel is a distance of n
+#define BUDGET_WEIGHT_R 2
+#define BUDGET_WEIGHT_G 4
+#define BUDGET_WEIGHT_B 3
+#define BUDGET_WEIGHT_SUM 9
+
+// longest run of cells considered for a single colour, bounds the work per row
+#define BUDGET_MAX_RUN 64
+
 namespace TermVideo
 {
     class Optimiser
@@ -18,8 +35,41 @@ namespace TermVideo
         Optimiser(uchar);
         void set_prev_colours(uchar r, uchar g, uchar b);
         void set_colour_threshold(uchar col_threshold);
-        bool should_apply_ansi_col(uchar r, uchar g, uchar b, std::string c);
+        bool should_apply_ansi_col(uchar r, uchar g, uchar b, uint32_t glyph);
+    };
+
+    /**
+     * @brief Recolours each row of RGB cells as the runs needing the fewest colour escape
+     *        bytes, every cell of a run shares the run's average colour and stays within
+     *        the perceptual distance bound of it
+     */
+    class BudgetOptimiser
+    {
+    private:
+        int max_error;
+        uchar col_threshold;
+
+        // cheapest escape bytes up to each column & the start of the last run to get there
+        std::vector<int> row_cost, run_start;
+
+        uint64_t frames, error_cells;
+        int64_t bytes_saved;
+        double error_total;
+
+        void optimise_row(Cell *cells, int width);
+        bool is_within_bound(int range_r, int range_g, int range_b);
+        int count_escape_bytes(const Cell *cells, int width);
+
+    public:
+        BudgetOptimiser();
+        BudgetOptimiser(uchar col_threshold, int max_error);
+        void set_colour_threshold(uchar col_threshold);
+        void optimise(std::vector<Cell> &cells, int width, int height);
+        double get_avg_bytes_saved();
+        double get_mean_error();
     };
+
+    int get_rgb_escape_length(uchar r, uchar g, uchar b);
 }
 
 #endif
\ No newline at end of file
@@ -6,6 +6,25 @@
 
 namespace TermVideo
 {
+    /**
+     * @brief How the pixels of a terminal cell are drawn
+     */
+    enum class RenderMode
+    {
+        // 1 pixel per cell as a full block or ASCII character
+        Block,
+        Ascii,
+        // 1 pixel per cell as a space in the background colour, runs of a colour are erased
+        Space,
+        // 2 pixels per cell stacked vertically, as the foreground & background of an upper half block
+        HalfBlock,
+        // pixels thresholded into dot or block patterns, 2x4 per cell for braille,
+        // 2x2 for quadrants and 2x3 for sextants
+        Braille,
+        Quadrant,
+        Sextant
+    };
+
     struct Options
     {
         Options();
@@ -13,17 +32,39 @@ namespace TermVideo
         std::string filename;
         std::string char_set;
         std::string audio_language;
+        std::string decode_thread_type;
+        std::string scaler;
+        std::string dither;
+        std::string export_path;
+        std::string playback_path;
+        std::string record_path;
+        RenderMode render_mode;
         unsigned char col_threshold;
         int frames_to_skip;
+        int frame_queue_size;
+        int decode_threads;
+        int encode_threads;
+        int colour_depth;
+        int colour_budget;
+        int max_threshold;
+        int min_colour_depth;
+        int min_scale;
+        int max_skip;
         int seek_step_ms;
+        int grid_width, grid_height;
         bool print_colour;
         bool force_aspect;
         bool use_buffer;
+        bool use_curses;
         bool force_avg_lumi;
         bool use_audio;
         bool display_frametime;
-        bool use_ascii;
         bool disable_frame_sync;
+        bool use_delta;
+        bool benchmark;
+        bool adaptive_quality;
+        bool compress_export;
+        bool headless;
     };
 
     int parse_arguments(Options &, int, char **);
@@ -28,10 +28,26 @@ namespace TermVideo
         double get_avg_frame_time_milli();
         int64 get_avg_wait_time();
 
+        void add_dropped_frame();
+        void add_late_frame();
+        void add_discarded_frames(int64);
+        void add_frame_bytes(int64);
+        void add_write_time(double);
+        int64 get_dropped_frames();
+        int64 get_late_frames();
+        int64 get_discarded_frames();
+        int64 get_avg_frame_bytes();
+        double get_avg_write_time_milli();
+        double get_max_write_time_milli();
+
     private:
         int frame_count;
         double frame_time_milli_total;
         int64 wait_time_total;
+        int64 dropped_frames, late_frames, discarded_frames;
+        int64 output_frames, output_bytes;
+        int64 write_count;
+        double write_time_milli_total, write_time_milli_max;
         std::chrono::_V2::system_clock::time_point start_time;
     };
 }
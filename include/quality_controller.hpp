@@ -0,0 +1,79 @@
+#ifndef QUALITY_CONTROLLER_H
+#define QUALITY_CONTROLLER_H
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+typedef unsigned char uchar;
+
+// frames measured before deciding on an adjustment
+#define QUALITY_WINDOW_FRAMES 30
+
+// a window is overloaded when more than 1 in this many frames are late, or the average
+// frame takes more than the percentage of the frame time. Underloaded windows have no
+// late frames and stay under the lower percentage
+#define QUALITY_LATE_DIVISOR 10
+#define QUALITY_BUSY_HIGH_PERCENT 90
+#define QUALITY_BUSY_LOW_PERCENT 50
+
+// writes taking more than this percentage of the frame time overload a window on their
+// own, a terminal slow to take output is what lowering quality helps with the most
+#define QUALITY_WRITE_HIGH_PERCENT 60
+
+// underloaded windows in a row needed before quality is raised again, so a single quiet
+// stretch doesn't undo an adjustment
+#define QUALITY_RECOVER_WINDOWS 3
+
+// smallest increase of the colour threshold & the step of the output scale
+#define QUALITY_THRESHOLD_STEP 8
+#define QUALITY_SCALE_STEP 10
+
+namespace TermVideo
+{
+    /**
+     * @brief Settings the quality controller adjusts while playing
+     */
+    struct QualitySettings
+    {
+        uchar col_threshold;
+        int colour_depth;
+        int scale_percent;
+        int frames_to_skip;
+    };
+
+    /**
+     * @brief Fits output to what the terminal keeps up with. Frame time, write latency &
+     *        lateness are measured over a window of frames, when frames run late the
+     *        colour threshold is raised first, then colour depth, output scale & frame
+     *        decimation are lowered, and raised back in reverse once frames are on time
+     */
+    class QualityController
+    {
+    public:
+        QualityController();
+        QualityController(QualitySettings, QualitySettings, bool);
+        bool add_frame(size_t, double, double, double, double, double);
+        const QualitySettings &get_settings();
+        const std::vector<std::string> &get_log();
+
+    private:
+        bool enabled;
+
+        // settings from launch are the best quality, limits are the worst allowed
+        QualitySettings initial, limits, settings;
+
+        int window_frames, window_late, quiet_windows;
+        double window_busy_milli, window_write_milli;
+        size_t window_bytes;
+
+        std::vector<std::string> log;
+
+        bool lower_quality(std::string &);
+        bool raise_quality(std::string &);
+        void add_log(double, const std::string &, double, double);
+    };
+}
+
+#endif
\ No newline at end of file
@@ -2,6 +2,8 @@
 #define RENDERER_H
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <format>
 #include <fstream>
@@ -10,12 +12,21 @@
 #include <thread>
 #include <vector>
 
+#include "cast_writer.hpp"
 #include "colour.hpp"
+#include "dither.hpp"
+#include "frame_encoder.hpp"
+#include "frame_queue.hpp"
+#include "kernels.hpp"
 #include "media.hpp"
 #include "optimiser.hpp"
 #include "options.hpp"
 #include "performance_checker.hpp"
+#include "quality_controller.hpp"
+#include "scaler.hpp"
 #include "terminal.hpp"
+#include "terminal_writer.hpp"
+#include "worker_pool.hpp"
 
 #ifdef __USE_OPENCV
 #include <opencv2/opencv.hpp>
@@ -46,6 +57,19 @@ typedef unsigned char uchar;
 
 #define FETCH_TERMINAL_INTERVAL 1
 
+// how far the decoded video can fall behind the audio clock before the decoder
+// skips non-reference frames, then everything but keyframes
+#define DISCARD_NONREF_LAG_MS 150
+#define DISCARD_NONKEY_LAG_MS 500
+
+// how far a queued frame can be behind the audio clock before it's dropped unseen,
+// at most MAX_CONSECUTIVE_DROPS in a row so the picture still moves
+#define PRESENT_DROP_LAG_MS 100
+#define MAX_CONSECUTIVE_DROPS 5
+
+// luminance at which a braille dot or block quadrant/sextant is drawn
+#define SUBCELL_THRESHOLD 128
+
 namespace TermVideo
 {
     struct VideoInfo : MediaInfo
@@ -57,6 +81,25 @@ namespace TermVideo
         int64_t time_pt_ms;
     };
 
+    /**
+     * @brief A downscaled frame ready for output, along with the terminal layout it was scaled for.
+     *        Width & height are in pixels, padding in terminal cells
+     */
+    struct VideoFrame
+    {
+        uchar *pixels;
+        int stride;
+        int width, height, channels;
+        int term_width, term_height;
+        int padding_x, padding_y;
+        double pts_ms;
+        int serial;
+
+#ifdef __USE_FFMPEG
+        AVFrame *frame;
+#endif
+    };
+
     class Renderer
     {
     public:
@@ -66,48 +109,115 @@ namespace TermVideo
         virtual void init_renderer();
         virtual void start_renderer();
         void seek(Seek);
-        std::string open_file();
+        std::string get_video_stream();
         std::string get_decoder();
 
-        Optimiser optimiser;
         PerformanceChecker perf_checker;
 
     protected:
+        void build_glyph_lut();
+        void build_subcell_glyphs();
         char pixel_to_ascii(uchar, uchar, uchar);
         void wait_for_frame();
+        void update_quality(double);
+        void print_stats();
+        virtual void present_frame(VideoFrame &);
+        void open_recording();
+        void record_frame(const VideoFrame &);
+        void close_recording();
 
 #if defined(__USE_OPENCV)
         cv::VideoCapture *cap;
         void frame_downscale_opencv(cv::Mat &);
 #elif defined(__USE_FFMPEG)
-        void frame_downscale_ffmpeg(AVFrame *);
+        bool frame_downscale_ffmpeg(AVFrame *, AVFrame *);
+        bool queue_frame(AVFrame *);
+        void update_frame_discard(double);
+        bool should_drop_frame(const VideoFrame &);
+        void decode_video_ffmpeg();
+        void process_video_ffmpeg();
+
+        Scaler scaler;
+        int scaler_src_width, scaler_src_height;
+        FrameQueue<VideoFrame> *frame_queue;
+        int decode_serial;
+        int consecutive_drops;
 #endif
 
         VideoInfo *info;
-        int frames_to_skip;
+        std::atomic<int> frames_to_skip;
+        int frame_queue_size;
+        int decode_threads;
+        std::string decode_thread_type;
         int width, height;
         int padding_x, padding_y;
         bool print_colour;
         bool force_aspect;
         bool ready;
         bool term_resized;
+        // frames are scaled for a fixed grid instead of the terminal's size
+        bool fixed_size;
         bool force_avg_luminance;
         bool display_frametime;
-        bool use_ascii;
         bool disable_frame_sync;
+        bool use_delta;
+        int colour_depth;
+        int colour_budget;
+        RenderMode render_mode;
+        // pixels drawn by each terminal cell
+        int cell_pixels_x, cell_pixels_y;
+
+        // braille, quadrant & sextant modes: bit of each pixel within a cell, the glyph of
+        // every bit pattern and the patterns of the cell row being built
+        std::array<std::array<uchar, 2>, 4> subcell_bits;
+        std::vector<uint32_t> subcell_glyphs;
+        std::vector<uchar> subcell_masks;
+        std::vector<uint32_t> subcell_sums;
+
+        // luminance of the row of pixels being laid out, from the row kernels
+        std::vector<uchar> row_luminance;
         uchar col_threshold;
         uchar prev_r, prev_g, prev_b;
         std::string filename, char_set;
+        // decoder & threading it settled on, printed with the stats since the terminal
+        // has been taken over by the time the decoder is opened
+        std::string decoder_summary;
+        std::array<char, 256> glyph_lut;
         std::chrono::steady_clock::time_point next_frame;
 
+        // cells of the frame being presented, encoded for the terminal by the encoder.
+        // Both are reused between frames so steady playback doesn't allocate
+        std::vector<Cell> cells;
+        FrameEncoder encoder;
+        WorkerPool *worker_pool;
+        Ditherer ditherer;
+        std::string frame_output;
+        TerminalWriter writer;
+
+        // asciinema recording of the frames, nullptr unless recording. Its clock follows the
+        // frames' timestamps, a seek only advances it by a frame
+        CastWriter *cast_writer;
+        std::string record_path;
+        double cast_time_ms, cast_pts_ms;
+        int cast_serial;
+        int cast_width, cast_height;
+
+        // output scale is set by the presenter & read by the decoder when scaling frames
+        QualityController quality;
+        std::atomic<int> output_scale;
+        int scaled_for_scale;
+
+        void frame_to_cells(const VideoFrame &);
+        void frame_to_half_blocks(const VideoFrame &);
+        void frame_to_subcells(const VideoFrame &);
+        void draw_frametime(const VideoFrame &);
+        void print(const std::string &ascii_frame);
+        void frame_to_ascii(std::string &, const VideoFrame &);
+
     private:
-        void frame_to_ascii(std::string &, uchar *, const int, const int, const int);
-        void print(std::string ascii_frame);
 
 #if defined(__USE_OPENCV)
         void process_video_opencv();
-#elif defined(__USE_FFMPEG)
-        void process_video_ffmpeg();
 #endif
     };
 }
@@ -0,0 +1,69 @@
+#ifndef SCALER_H
+#define SCALER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+extern "C"
+{
+#include <libavutil/frame.h>
+#include <libswscale/swscale.h>
+}
+
+typedef unsigned char uchar;
+
+// scaler contexts kept around for previous terminal sizes & sources
+#define SCALER_CACHE_SIZE 4
+
+namespace TermVideo
+{
+    struct ScalerKey
+    {
+        int src_width, src_height, src_format;
+        int dst_width, dst_height, dst_format;
+
+        bool operator==(const ScalerKey &) const = default;
+    };
+
+    /**
+     * @brief Downscales decoded frames for the renderer, either through swscale contexts
+     *        cached by geometry & pixel format or through an internal box filter that
+     *        averages each cell's block of source pixels
+     */
+    class Scaler
+    {
+    public:
+        Scaler();
+        ~Scaler();
+        static bool is_valid_algorithm(std::string);
+        void set_algorithm(std::string);
+        bool scale(const AVFrame *, AVFrame *);
+
+    private:
+        struct CacheEntry
+        {
+            ScalerKey key;
+            SwsContext *ctx;
+            uint64_t last_used;
+        };
+
+        std::vector<CacheEntry> cache;
+        uint64_t use_count;
+        int sws_flags;
+        bool use_box_filter;
+
+        // first & past the last source column & row of each output cell for the box filter,
+        // boxes overlap when upscaling
+        ScalerKey box_key;
+        std::vector<int> box_x, box_x_end, box_y, box_y_end;
+        std::vector<uint32_t> box_sums;
+
+        SwsContext *get_context(const ScalerKey &);
+        bool box_scale(const AVFrame *, AVFrame *);
+        void box_bounds(const ScalerKey &);
+    };
+}
+
+#endif
\ No newline at end of file
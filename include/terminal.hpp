@@ -22,7 +22,8 @@ namespace TermVideo
     void set_terminal_title(std::string);
     void hide_terminal_cursor();
     void get_terminal_size(int &, int &, bool &);
-    void init_terminal_col(bool);
+    void init_terminal_col(bool, int);
+    std::string get_terminal_col(bool, int);
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,55 @@
+#ifndef TERMINAL_WRITER_H
+#define TERMINAL_WRITER_H
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#if defined(__linux__)
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/uio.h>
+#include <termios.h>
+#include <unistd.h>
+#endif
+
+// synchronized output, the terminal holds back drawing until the end sequence
+#define SYNC_OUTPUT_BEGIN "\033[?2026h"
+#define SYNC_OUTPUT_END "\033[?2026l"
+
+// longest wait for the terminal to answer whether it supports synchronized output
+#define SYNC_QUERY_TIMEOUT_MS 200
+
+namespace TermVideo
+{
+    /**
+     * @brief Writes frames straight to the terminal's file descriptor, a whole frame in a
+     *        single system call when the terminal keeps up. Frames are wrapped in
+     *        synchronized output sequences when the terminal supports them
+     */
+    class TerminalWriter
+    {
+    public:
+        TerminalWriter();
+        void open();
+        bool write_frame(const std::string &);
+        bool write_frame(const char *, size_t);
+        bool is_sync_supported();
+        double get_last_write_time_milli();
+        size_t get_last_write_bytes();
+
+    private:
+        int fd;
+        bool sync_supported;
+        double last_write_time_milli;
+        size_t last_write_bytes;
+
+#if defined(__linux__)
+        bool query_sync_support();
+#endif
+    };
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,126 @@
+#ifndef TVID_H
+#define TVID_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define TVID_MAGIC "TVID"
+#define TVID_VERSION 2
+
+// header flags
+#define TVID_FLAG_COLOUR 1
+#define TVID_FLAG_BACKGROUND 2
+
+// how frames are stored, as the bytes written to the terminal or compressed cells
+// which are encoded for the terminal on playback
+#define TVID_CODEC_TERMINAL 0
+#define TVID_CODEC_CELLS 1
+
+// a full repaint is stored at least this often, so seeking never replays more than this
+#define TVID_KEYFRAME_INTERVAL_MS 2000
+
+namespace TermVideo
+{
+    /**
+     * @brief Start of a .tvid file, followed by the stored bytes of every frame and then the
+     *        index. Values are stored in the byte order of the machine that exported the file.
+     *        Compressed cells are encoded on playback with the frame encoder settings here
+     */
+    struct TvidHeader
+    {
+        char magic[4];
+        uint32_t version;
+        uint32_t width, height;
+        uint32_t colour_depth;
+        uint32_t flags;
+        uint32_t codec;
+        uint32_t col_threshold;
+        uint32_t colour_budget;
+        char dither[12];
+        uint64_t frametime_ns;
+        uint64_t frame_count;
+        uint64_t index_offset;
+    };
+
+    /**
+     * @brief Where a frame's bytes are in the file and when it's shown. Frames are stored one
+     *        after another, keyframes redraw every cell and the frames after them are deltas
+     */
+    struct TvidIndexEntry
+    {
+        uint64_t offset;
+        uint32_t length;
+        uint32_t keyframe;
+        double pts_ms;
+    };
+
+    /**
+     * @brief Writes encoded frames into a .tvid file, the index is written on closing
+     */
+    class TvidWriter
+    {
+    public:
+        TvidWriter();
+        ~TvidWriter();
+        TvidWriter(const TvidWriter &) = delete;
+        TvidWriter &operator=(const TvidWriter &) = delete;
+
+        std::string open(const std::string &, const TvidHeader &);
+        bool add_frame(const std::string &, double, bool);
+        std::string close(uint64_t);
+        uint64_t get_frame_count();
+        uint64_t get_keyframe_count();
+        uint64_t get_frame_bytes();
+
+    private:
+        FILE *file;
+        TvidHeader header;
+        std::vector<TvidIndexEntry> index;
+        uint64_t offset;
+        uint64_t keyframes;
+    };
+
+    /**
+     * @brief Maps a .tvid file into memory, frames are read straight from the mapping
+     */
+    class TvidReader
+    {
+    public:
+        TvidReader();
+        ~TvidReader();
+        TvidReader(const TvidReader &) = delete;
+        TvidReader &operator=(const TvidReader &) = delete;
+
+        std::string open(const std::string &);
+        const TvidHeader &get_header();
+        uint64_t get_frame_count();
+        const TvidIndexEntry &get_entry(uint64_t);
+        const char *get_frame_data(uint64_t);
+        uint64_t find_frame(double);
+        uint64_t find_keyframe(uint64_t);
+
+    private:
+        const char *data;
+        size_t size;
+        const TvidHeader *header;
+        const TvidIndexEntry *index;
+
+#if !defined(__linux__)
+        std::vector<char> contents;
+#endif
+    };
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,52 @@
+#ifndef TVID_PLAYER_H
+#define TVID_PLAYER_H
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "cell_codec.hpp"
+#include "frame_encoder.hpp"
+#include "media.hpp"
+#include "options.hpp"
+#include "performance_checker.hpp"
+#include "terminal.hpp"
+#include "terminal_writer.hpp"
+#include "tvid.hpp"
+
+namespace TermVideo
+{
+    /**
+     * @brief Plays a .tvid file by writing its pre-rendered frames straight from the mapped
+     *        file to the terminal. Compressed cells are decoded & encoded for the terminal first
+     */
+    class TvidPlayer
+    {
+    public:
+        TvidPlayer(MediaInfo *, Options);
+        std::string init_player();
+        void play();
+
+    private:
+        MediaInfo *info;
+        TvidReader reader;
+        TerminalWriter writer;
+        PerformanceChecker perf_checker;
+        std::string filename;
+        bool disable_frame_sync;
+
+        // used for compressed cells only
+        CellCodec codec;
+        FrameEncoder encoder;
+        std::vector<Cell> cells;
+        std::string output;
+        bool decode_cells;
+
+        uint64_t seek_to(double);
+        bool write_frames(uint64_t, uint64_t);
+        bool write_cell_frames(uint64_t, uint64_t);
+    };
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,66 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <type_traits>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace TermVideo
+{
+    /**
+     * @brief Persistent threads running the tasks of a job in parallel. The thread calling
+     *        run takes tasks too, so a pool of 1 thread runs everything on the caller
+     */
+    class WorkerPool
+    {
+    public:
+        WorkerPool(int thread_count);
+        ~WorkerPool();
+        WorkerPool(const WorkerPool &) = delete;
+        WorkerPool &operator=(const WorkerPool &) = delete;
+
+        /**
+         * @brief Runs every task of a job across the pool, returning once they're all done.
+         *        The task is called through a plain function pointer instead of being
+         *        wrapped in a std::function, so running a job never allocates
+         *
+         * @param task_count Number of tasks
+         * @param task Callable running a single task, given the index of the task
+         */
+        template <typename F>
+        void run(int task_count, F &&task)
+        {
+            using Task = std::remove_reference_t<F>;
+            this->run_job(task_count, [](void *context, int index)
+                          { (*static_cast<Task *>(context))(index); },
+                          const_cast<void *>(static_cast<const void *>(&task)));
+        }
+
+        int get_thread_count();
+
+    private:
+        std::vector<std::thread> threads;
+        std::mutex mutex;
+        std::condition_variable start_cond, done_cond;
+
+        // job being run, workers claim task indices until they run out
+        void (*task)(void *, int);
+        void *task_context;
+        int task_count;
+        std::atomic<int> next_task;
+        int busy_workers;
+        uint64_t job;
+        bool stopping;
+
+        void run_job(int, void (*)(void *, int), void *);
+        void work();
+        void run_tasks();
+    };
+}
+
+#endif
\ No newline at end of file
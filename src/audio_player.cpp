@@ -1,4 +1,5 @@
 #include "audio_player.hpp"
+#include "demuxer.hpp"
 #include "media.hpp"
 
 namespace TermVideo
@@ -7,7 +8,11 @@ namespace TermVideo
     {
         this->info = static_cast<AudioInfo *>(info);
         this->info->a_clock_ms = 0;
-        this->info->a_format_ctx = nullptr;
+        this->info->a_stream = nullptr;
+        this->info->a_codec_ctx = nullptr;
+        this->info->a_swr_ctx = nullptr;
+        this->a_device = nullptr;
+        this->use_audio = false;
     }
 
     AudioPlayer::~AudioPlayer()
@@ -18,7 +23,6 @@ namespace TermVideo
         {
             swr_free(&this->info->a_swr_ctx);
             avcodec_free_context(&this->info->a_codec_ctx);
-            avformat_close_input(&this->info->a_format_ctx);
         }
         ao_shutdown();
     }
@@ -28,9 +32,9 @@ namespace TermVideo
         // Find preferred audio stream language if exists
         if (audio_language.length() > 0)
         {
-            for (size_t i = 0; i < this->info->a_format_ctx->nb_streams; ++i)
+            for (size_t i = 0; i < this->info->format_ctx->nb_streams; ++i)
             {
-                AVStream *stream = this->info->a_format_ctx->streams[i];
+                AVStream *stream = this->info->format_ctx->streams[i];
                 if (stream->codecpar->codec_type != AVMEDIA_TYPE_AUDIO)
                     continue;
 
@@ -45,7 +49,7 @@ namespace TermVideo
 
         // Fall back to best stream available
         int stream_index = av_find_best_stream(
-            this->info->a_format_ctx,
+            this->info->format_ctx,
             AVMEDIA_TYPE_AUDIO,
             -1,
             -1,
@@ -54,7 +58,7 @@ namespace TermVideo
         if (stream_index < 0)
             return "No audio streams found in file!";
 
-        this->info->a_stream = this->info->a_format_ctx->streams[stream_index];
+        this->info->a_stream = this->info->format_ctx->streams[stream_index];
         return "";
     }
 
@@ -64,21 +68,15 @@ namespace TermVideo
         if (!this->use_audio)
             return "";
 
-        int ret = avformat_open_input(
-            &this->info->a_format_ctx,
-            opts.filename.c_str(),
-            nullptr,
-            nullptr);
-        if (ret < 0)
-            return "Unable to open media file!";
-
-        ret = avformat_find_stream_info(this->info->a_format_ctx, nullptr);
-        if (ret < 0)
-            return "Unable to find stream info!";
-
+        // the file is already opened by the demuxer
         std::string res = this->decode_file(opts);
         if (res.length() > 0)
+        {
+            // without a stream, the demuxer won't queue audio packets
+            this->use_audio = false;
+            this->info->a_stream = nullptr;
             return res;
+        }
 
         return "";
     }
@@ -157,18 +155,22 @@ namespace TermVideo
 
         AVPacket *packet = av_packet_alloc();
         AVFrame *frame = av_frame_alloc();
+        int serial = 0, last_serial = 0;
 
         while (1)
         {
-            if (this->info->a_seek.req)
-                this->seek(this->info->a_seek);
-
-            int ret = av_read_frame(this->info->a_format_ctx, packet);
-            if (ret < 0)
+            int ret = this->info->a_packets->get(packet, serial);
+            if (ret <= 0)
                 break;
 
-            if (packet->stream_index != this->info->a_stream->index ||
-                avcodec_send_packet(this->info->a_codec_ctx, packet) ||
+            // demuxer has seeked, the packet comes from the new position
+            if (serial != last_serial)
+            {
+                this->seek(this->info->seek);
+                last_serial = serial;
+            }
+
+            if (avcodec_send_packet(this->info->a_codec_ctx, packet) ||
                 avcodec_receive_frame(this->info->a_codec_ctx, frame))
             {
                 av_packet_unref(packet);
@@ -216,21 +218,13 @@ namespace TermVideo
         av_packet_free(&packet);
     }
 
+    /**
+     * @brief Drops decoder state after the demuxer has seeked
+     * @param seek_info Position the demuxer seeked to
+     */
     void AudioPlayer::seek(Seek seek_info)
     {
-        int64_t time_u = this->info->a_stream->time_base.den;
-        int64_t timestamp = (seek_info.pos * time_u) / 1000;
-
-        if (timestamp < 0)
-            timestamp = 0;
-
-        int ret = av_seek_frame(this->info->a_format_ctx,
-                                this->info->a_stream->index,
-                                timestamp,
-                                seek_info.flags);
         avcodec_flush_buffers(this->info->a_codec_ctx);
-
-        this->info->a_clock_ms = seek_info.pos;
-        this->info->a_seek.req = false;
+        this->info->a_clock_ms = std::max(seek_info.pos, 0.0);
     }
 }
\ No newline at end of file
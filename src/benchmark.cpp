@@ -0,0 +1,322 @@
+#include "benchmark.hpp"
+
+/**
+ * @brief Times a function over several passes
+ *
+ * @param pass Function running a single pass
+ * @return double Average milliseconds per pass
+ */
+template <typename F>
+static double time_passes(F pass)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < BENCHMARK_PASSES; i++)
+        pass();
+    auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::milli>(end - start).count() / BENCHMARK_PASSES;
+}
+
+static void print_result(const std::string &name, double time_ms, double baseline_ms)
+{
+    std::cout << "  " << name << ": " << time_ms << "ms (" << baseline_ms / time_ms << "x)" << std::endl;
+}
+
+#if defined(__linux__)
+/**
+ * @brief Times the ncurses colour pair lookup table against computing the index per pixel,
+ *        on a 6x6x6 cube of pairs
+ *
+ * @param bgr Random pixels
+ */
+static void benchmark_colour_pairs(const std::vector<uchar> &bgr)
+{
+    using namespace TermVideo;
+
+    const int levels = 6;
+    std::vector<uchar> colours;
+    for (int i = 0; i < levels * levels * levels; i++)
+    {
+        colours.push_back(static_cast<uchar>(i / (levels * levels) * 255 / (levels - 1)));
+        colours.push_back(static_cast<uchar>(i / levels % levels * 255 / (levels - 1)));
+        colours.push_back(static_cast<uchar>(i % levels * 255 / (levels - 1)));
+    }
+
+    std::vector<uchar> lut;
+    auto start = std::chrono::steady_clock::now();
+    lut = build_colour_pair_lut(colours);
+    double build_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<int> pairs(BENCHMARK_PIXELS);
+    double baseline = time_passes([&]
+                                  {
+        for (int i = 0; i < BENCHMARK_PIXELS; i++)
+            pairs[i] = get_ncurses_col_index(bgr[i * 3 + 2], bgr[i * 3 + 1], bgr[i * 3], levels - 1); });
+    double lut_ms = time_passes([&]
+                                {
+        for (int i = 0; i < BENCHMARK_PIXELS; i++)
+            pairs[i] = lut[get_palette_lut_index(bgr[i * 3 + 2], bgr[i * 3 + 1], bgr[i * 3])] + 1; });
+
+    std::cout << "Colour pairs, lookup table built in " << build_ms << "ms" << std::endl;
+    print_result("get_ncurses_col_index", baseline, baseline);
+    print_result("lookup table", lut_ms, baseline);
+}
+#endif
+
+/**
+ * @brief Times encoding a frame of coloured cells across 1 to a thread per core, checking
+ *        the output is the same for every thread count
+ *
+ * @param bgr Random pixels, at least the size of the terminal
+ */
+static void benchmark_encode_threads(const std::vector<uchar> &bgr)
+{
+    using namespace TermVideo;
+
+    const int width = BENCHMARK_TERM_WIDTH, height = BENCHMARK_TERM_HEIGHT;
+    const int max_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    // smooth gradients with some noise, like a downscaled frame
+    std::vector<Cell> frame(width * height);
+    for (int row = 0; row < height; row++)
+    {
+        for (int col = 0; col < width; col++)
+        {
+            const uchar *noise = &bgr[(row * width + col) * 3];
+            frame[row * width + col] = {'#',
+                                        static_cast<uchar>(col * 255 / width ^ (noise[2] & 0x0F)),
+                                        static_cast<uchar>(row * 255 / height ^ (noise[1] & 0x0F)),
+                                        static_cast<uchar>(noise[0] & 0x3F),
+                                        0, 0, 0, 0, 0};
+        }
+    }
+
+    std::cout << "Frame encoding, " << width << "x" << height << " cells" << std::endl;
+
+    std::string baseline_output;
+    double baseline_ms = 0;
+    for (int threads = 1; threads <= max_threads; threads++)
+    {
+        WorkerPool pool(threads);
+        FrameEncoder encoder(true, 4, false, 24, false, 0, "none");
+        encoder.set_worker_pool(&pool);
+
+        std::vector<Cell> cells;
+        std::string output;
+        double time_ms = time_passes([&]
+                                     {
+            cells = frame;
+            encoder.encode(cells, width, height, output); });
+
+        if (threads == 1)
+        {
+            baseline_ms = time_ms;
+            baseline_output = output;
+        }
+        print_result(std::to_string(threads) + " thread" + (threads > 1 ? "s" : ""), time_ms, baseline_ms);
+
+        if (output != baseline_output)
+            std::cout << "  " << threads << " threads output differs from 1 thread!" << std::endl;
+    }
+}
+
+/**
+ * @brief Fills a frame of the built-in clip, a banded background gradient scrolling sideways
+ *        with a bright blob moving across it. Cells use half blocks with both colours
+ *
+ * @param frame Cells of the frame
+ * @param index Index of the frame in the clip
+ */
+static void fill_clip_frame(std::vector<TermVideo::Cell> &frame, int index)
+{
+    const int width = BENCHMARK_CLIP_WIDTH, height = BENCHMARK_CLIP_HEIGHT;
+    const int blob_x = index * width / BENCHMARK_CLIP_FRAMES, blob_y = height / 2 + (index % 20 - 10) / 2;
+
+    frame.resize(width * height);
+    for (int row = 0; row < height; row++)
+    {
+        for (int col = 0; col < width; col++)
+        {
+            const uchar shade = static_cast<uchar>((col + index / 2) / 8 % 16 * 16);
+            const int dx = col - blob_x, dy = (row - blob_y) * 2;
+            const bool blob = dx * dx + dy * dy < 64;
+
+            frame[row * width + col] = {0x2580,
+                                        static_cast<uchar>(blob ? 255 : shade), static_cast<uchar>(blob ? 220 : row / 4 * 24), shade, 0,
+                                        shade, static_cast<uchar>(blob ? 200 : row / 4 * 24), 64, 0};
+        }
+    }
+}
+
+/**
+ * @brief Exports the built-in clip as terminal bytes & as compressed cells, then times
+ *        decoding the cells and encoding them for the terminal like playback does. Also
+ *        checks every decoded frame matches the clip
+ */
+static void benchmark_cell_codec()
+{
+    using namespace TermVideo;
+
+    const int width = BENCHMARK_CLIP_WIDTH, height = BENCHMARK_CLIP_HEIGHT;
+    FrameEncoder encoder(true, 0, true, 24, true, 0, "none");
+    CellCodec codec(true, true, 0);
+
+    std::vector<Cell> frame, cells;
+    std::vector<std::string> frames(BENCHMARK_CLIP_FRAMES);
+    std::string output;
+    size_t terminal_bytes = 0, cell_bytes = 0;
+    for (int i = 0; i < BENCHMARK_CLIP_FRAMES; i++)
+    {
+        const bool keyframe = i % BENCHMARK_CLIP_KEYFRAMES == 0;
+        fill_clip_frame(frame, i);
+
+        if (keyframe)
+            encoder.force_full_repaint();
+        cells = frame;
+        encoder.encode(cells, width, height, output);
+        terminal_bytes += output.length();
+
+        codec.encode(frame, width, height, keyframe, frames[i]);
+        cell_bytes += frames[i].length();
+    }
+
+    // decodes into a fresh codec & encoder each pass, like playing from the start
+    bool matches = true;
+    size_t played_bytes = 0;
+    double decode_ms = time_passes([&]
+                                   {
+        CellCodec player_codec(true, true, 0);
+        FrameEncoder player_encoder(true, 0, true, 24, true, 0, "none");
+        played_bytes = 0;
+        for (int i = 0; i < BENCHMARK_CLIP_FRAMES; i++)
+        {
+            matches &= player_codec.decode(frames[i].data(), frames[i].length(), width, height);
+            cells = player_codec.get_cells();
+            player_encoder.encode(cells, width, height, output);
+            played_bytes += output.length();
+        } });
+
+    for (int i = 0; i < BENCHMARK_CLIP_FRAMES && matches; i++)
+    {
+        CellCodec check_codec(true, true, 0);
+        for (int j = i - i % BENCHMARK_CLIP_KEYFRAMES; j <= i; j++)
+            check_codec.decode(frames[j].data(), frames[j].length(), width, height);
+
+        fill_clip_frame(frame, i);
+        const std::vector<Cell> &decoded = check_codec.get_cells();
+        for (size_t c = 0; c < frame.size() && matches; c++)
+            matches = decoded[c].glyph == frame[c].glyph && decoded[c].r == frame[c].r && decoded[c].g == frame[c].g &&
+                      decoded[c].b == frame[c].b && decoded[c].bg_r == frame[c].bg_r && decoded[c].bg_g == frame[c].bg_g &&
+                      decoded[c].bg_b == frame[c].bg_b;
+    }
+
+    std::cout << "Compressed cells, " << BENCHMARK_CLIP_FRAMES << " frames of " << width << "x" << height << " cells" << std::endl;
+    std::cout << "  terminal bytes: " << terminal_bytes << ", compressed cells: " << cell_bytes
+              << " (" << static_cast<double>(terminal_bytes) / cell_bytes << "x smaller)" << std::endl;
+    std::cout << "  decode & encode: " << decode_ms / BENCHMARK_CLIP_FRAMES << "ms/frame, "
+              << BENCHMARK_CLIP_FRAMES * 1000.0 / decode_ms << " frames/s, "
+              << cell_bytes / 1000.0 / decode_ms << "MB/s in, " << played_bytes / 1000.0 / decode_ms << "MB/s out" << std::endl;
+
+    if (!matches)
+        std::cout << "  decoded frames differ from the clip!" << std::endl;
+}
+
+/**
+ * @brief Compares the row kernels against the per pixel functions they replace, on random
+ *        pixels the size of a 1080p frame. Also checks every kernel matches the scalar output,
+ *        then times the colour pair lookup, frame encoding across thread counts and playing
+ *        back compressed cells
+ */
+void TermVideo::run_benchmark()
+{
+    std::mt19937 rng(0);
+    std::uniform_int_distribution<int> byte(0, 255), noise(-8, 8);
+
+    std::vector<uchar> bgr(BENCHMARK_PIXELS * 3), ref_bgr(BENCHMARK_PIXELS * 3);
+    for (size_t i = 0; i < bgr.size(); i++)
+    {
+        bgr[i] = static_cast<uchar>(byte(rng));
+        ref_bgr[i] = static_cast<uchar>(std::clamp(bgr[i] + noise(rng), 0, 255));
+    }
+
+    std::vector<uchar> luminance(BENCHMARK_PIXELS), changed(BENCHMARK_PIXELS);
+    std::vector<uchar> scalar_luminance(BENCHMARK_PIXELS), scalar_changed(BENCHMARK_PIXELS);
+    const uchar threshold = 4;
+
+    std::vector<const Kernels *> kernels = get_supported_kernels();
+    kernels.front()->luminance_row(bgr.data(), scalar_luminance.data(), BENCHMARK_PIXELS, false);
+    kernels.front()->colour_changed_row(bgr.data(), ref_bgr.data(), BENCHMARK_PIXELS, threshold, scalar_changed.data());
+
+    std::cout << "Kernel benchmark, " << BENCHMARK_PIXELS << " pixels, average of " << BENCHMARK_PASSES
+              << " passes. Runtime picks " << get_kernels().name << std::endl;
+
+    // what the renderer called once per cell before the row kernels
+    double luminance_baseline = time_passes([&]
+                                            {
+        for (int i = 0; i < BENCHMARK_PIXELS; i++)
+            luminance[i] = get_luminance_approximate(bgr[i * 3 + 2], bgr[i * 3 + 1], bgr[i * 3], false); });
+
+    std::cout << "Luminance" << std::endl;
+    print_result("get_luminance_approximate", luminance_baseline, luminance_baseline);
+    for (const Kernels *k : kernels)
+    {
+        double time_ms = time_passes([&]
+                                     { k->luminance_row(bgr.data(), luminance.data(), BENCHMARK_PIXELS, false); });
+        print_result(k->name, time_ms, luminance_baseline);
+
+        if (luminance != scalar_luminance)
+            std::cout << "  " << k->name << " output differs from scalar!" << std::endl;
+    }
+
+    Optimiser optimiser(threshold);
+    double changed_baseline = time_passes([&]
+                                          {
+        for (int i = 0; i < BENCHMARK_PIXELS; i++)
+        {
+            optimiser.set_prev_colours(ref_bgr[i * 3 + 2], ref_bgr[i * 3 + 1], ref_bgr[i * 3]);
+            changed[i] = optimiser.should_apply_ansi_col(bgr[i * 3 + 2], bgr[i * 3 + 1], bgr[i * 3], '#');
+        } });
+
+    std::cout << "Colour change" << std::endl;
+    print_result("Optimiser::should_apply_ansi_col", changed_baseline, changed_baseline);
+    for (const Kernels *k : kernels)
+    {
+        double time_ms = time_passes([&]
+                                     { k->colour_changed_row(bgr.data(), ref_bgr.data(), BENCHMARK_PIXELS, threshold, changed.data()); });
+        print_result(k->name, time_ms, changed_baseline);
+
+        if (changed != scalar_changed)
+            std::cout << "  " << k->name << " output differs from scalar!" << std::endl;
+    }
+
+    // Bayer dithering offsets, every byte is either added to or subtracted from
+    std::vector<uchar> add(BENCHMARK_PIXELS * 3), sub(BENCHMARK_PIXELS * 3);
+    std::vector<uchar> offset(BENCHMARK_PIXELS * 3), scalar_offset(BENCHMARK_PIXELS * 3);
+    for (size_t i = 0; i < add.size(); i++)
+    {
+        int value = noise(rng) * 4;
+        add[i] = static_cast<uchar>(std::max(value, 0));
+        sub[i] = static_cast<uchar>(std::max(-value, 0));
+    }
+    kernels.front()->offset_row(bgr.data(), add.data(), sub.data(), BENCHMARK_PIXELS * 3, scalar_offset.data());
+
+    double offset_baseline = time_passes([&]
+                                         { kernels.front()->offset_row(bgr.data(), add.data(), sub.data(), BENCHMARK_PIXELS * 3, offset.data()); });
+
+    std::cout << "Dither offsets" << std::endl;
+    for (const Kernels *k : kernels)
+    {
+        double time_ms = time_passes([&]
+                                     { k->offset_row(bgr.data(), add.data(), sub.data(), BENCHMARK_PIXELS * 3, offset.data()); });
+        print_result(k->name, time_ms, offset_baseline);
+
+        if (offset != scalar_offset)
+            std::cout << "  " << k->name << " output differs from scalar!" << std::endl;
+    }
+
+#if defined(__linux__)
+    benchmark_colour_pairs(bgr);
+#endif
+    benchmark_encode_threads(bgr);
+    benchmark_cell_codec();
+}
\ No newline at end of file
@@ -19,131 +19,172 @@ TermVideo::BufferRenderer::~BufferRenderer()
 }
 
 TermVideo::BufferRenderer::BufferRenderer(MediaInfo *info, Options opts)
+    : Renderer(info, opts)
 {
-    this->info = static_cast<VideoInfo *>(info);
-    this->info->v_clock_ms = 0;
-    this->info->seek_step_ms = opts.seek_step_ms;
-
-#ifdef __USE_FFMPEG
-    this->info->v_sws_ctx = nullptr;
-#endif
-
-    this->frames_to_skip = opts.frames_to_skip;
-    this->print_colour = opts.print_colour;
-    this->force_aspect = opts.force_aspect;
-    this->filename = opts.filename;
-    this->char_set = opts.char_set;
-    this->disable_frame_sync = opts.disable_frame_sync;
-
-    this->padding_x = this->padding_y = 0;
-    this->prev_r = this->prev_g = this->prev_b = 255;
-    this->next_frame = std::chrono::steady_clock::now();
-    this->perf_checker = PerformanceChecker();
-
-    this->ready = false;
-#if defined(__linux__)
-    this->color_step_no = 1;
+    this->buffer_width = this->buffer_height = 0;
+#if defined(_WIN32)
+    this->buffer = nullptr;
+#elif defined(__linux__)
+    this->use_curses = opts.use_curses;
+    this->colour_levels = 2;
 #endif
 }
 
 #if defined(__linux__)
 /**
- * @brief Sets optimised colours based on total number of colour supported by the terminal
+ * @brief Sets up the colour pairs based on total number of colour supported by the terminal,
+ *        then rebuilds the lookup table of the nearest pair to every colour
  */
 void TermVideo::BufferRenderer::set_curses_colors()
 {
-    if (COLORS == 8 || !can_change_color())
-        return;
+    const int max_pairs = std::min(COLOR_PAIRS - 1, CURSES_MAX_PAIRS);
+    this->pair_colours.clear();
 
-    // subtract 1 because rgb=0 is included
-    // eg. if cbrt(COLORS)=6, colour values=(0, 200, 400, 600, 800, 1000)
-    // which is 5 steps instead of 6
-    this->color_step_no = floor(std::cbrt(COLORS)) - 1;
-    double col_step_amt = 1000 / this->color_step_no;
-
-    for (int r = 0; r < this->color_step_no; r++)
+    if (COLORS > 8 && can_change_color())
     {
-        for (int g = 0; g < this->color_step_no; g++)
+        // an evenly spaced cube of colours, each level from 0 to 1000 in init_color
+        // eg. if cbrt(COLORS)=6, colour values=(0, 200, 400, 600, 800, 1000)
+        this->colour_levels = std::max(2, static_cast<int>(std::cbrt(std::min(COLORS, max_pairs))));
+        const int steps = this->colour_levels - 1;
+
+        for (int r = 0; r < this->colour_levels; r++)
         {
-            for (int b = 0; b < this->color_step_no; b++)
+            for (int g = 0; g < this->colour_levels; g++)
             {
-                short index = (r * this->color_step_no * this->color_step_no) + (g * this->color_step_no) + b;
-                short r_val = col_step_amt * r,
-                      g_val = col_step_amt * g,
-                      b_val = col_step_amt * b;
-                init_color(index, r_val, g_val, b_val);
-
-                // for colour pairs, foreground will change while background will always be black
-                init_pair(index, index, 0);
+                for (int b = 0; b < this->colour_levels; b++)
+                {
+                    short index = (r * this->colour_levels * this->colour_levels) + (g * this->colour_levels) + b;
+                    init_color(index, r * 1000 / steps, g * 1000 / steps, b * 1000 / steps);
+
+                    // for colour pairs, foreground will change while background will always be black
+                    init_pair(index + 1, index, 0);
+                    this->pair_colours.insert(this->pair_colours.end(), {static_cast<uchar>(r * 255 / steps),
+                                                                         static_cast<uchar>(g * 255 / steps),
+                                                                         static_cast<uchar>(b * 255 / steps)});
+                }
             }
         }
     }
+    else
+    {
+        // the terminal's own colours, 8 & 16 colour terminals only have the corners of the cube
+        const int count = std::min(COLORS, max_pairs);
+        this->colour_levels = (count >= 216) ? 6 : 2;
+
+        for (short index = 0; index < count; index++)
+        {
+            short r, g, b;
+            color_content(index, &r, &g, &b);
+            init_pair(index + 1, index, 0);
+            this->pair_colours.insert(this->pair_colours.end(), {static_cast<uchar>(r * 255 / 1000),
+                                                                 static_cast<uchar>(g * 255 / 1000),
+                                                                 static_cast<uchar>(b * 255 / 1000)});
+        }
+    }
+
+    this->pair_lut = build_colour_pair_lut(this->pair_colours);
 }
 #endif
 
 /**
  * @brief Converts a full frame into a series of ASCII characters and displays them
  *
- * @param frame_pixels Vector of pixels in RGB order
- * @param width Width of the frame
- * @param height Height of the frame
- * @param channels No of colour channels for each pixel
+ * @param video_frame Downscaled frame along with the terminal layout it was scaled for
  */
-void TermVideo::BufferRenderer::frame_to_ascii(uchar *frame_pixels, const int width, const int height, const int channels)
+void TermVideo::BufferRenderer::frame_to_ascii(const VideoFrame &video_frame)
 {
-    this->perf_checker.start_frame_time();
+    uchar *frame_pixels = video_frame.pixels;
+    const int width = video_frame.width,
+              height = video_frame.height,
+              channels = video_frame.channels,
+              stride = video_frame.stride;
+
+#if defined(__linux__)
+    this->row_chars.resize(width);
+#endif
 
     for (int row = 0; row < height; row++)
     {
 #if defined(_WIN32)
         for (int col = 0; col < width; col++)
         {
-            ULONG index = channels * (row * width + col);
+            ULONG index = row * stride + channels * col;
             uchar pixel_b = frame_pixels[index],
-                  pixel_g = frame_pixels[index + 1],
-                  pixel_r = frame_pixels[index + 2];
+                  pixel_g = pixel_b,
+                  pixel_r = pixel_b;
+
+            if (channels >= 3)
+            {
+                pixel_g = frame_pixels[index + 1];
+                pixel_r = frame_pixels[index + 2];
+            }
 
-            char ascii = this->pixel_to_ascii(pixel_r, pixel_g, pixel_b);
+            // grayscale frames already hold the luminance
+            char ascii = (channels == 1) ? this->glyph_lut[pixel_b] : this->pixel_to_ascii(pixel_r, pixel_g, pixel_b);
 
             if (this->print_colour)
             {
                 WORD attr = TermVideo::get_win32_col(pixel_r, pixel_g, pixel_b);
-                this->write_to_buffer(row + this->padding_y, col + this->padding_x, ascii, attr);
+                this->write_to_buffer(row + video_frame.padding_y, col + video_frame.padding_x, ascii, attr);
             }
             else
             {
                 // forces text to be white
                 WORD white_attr = FOREGROUND_INTENSITY | FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE;
-                this->write_to_buffer(row + this->padding_y, col + this->padding_x, ascii, white_attr);
+                this->write_to_buffer(row + video_frame.padding_y, col + video_frame.padding_x, ascii, white_attr);
             }
         }
 #elif defined(__linux__)
+        // colour pairs only cover a few levels per channel, so their colours are dithered
+        const uchar *dithered = nullptr;
+        if (this->print_colour && channels == 3 && this->ditherer.is_enabled())
+        {
+            const uchar *line = frame_pixels + row * stride;
+            this->dither_pixels.assign(line, line + width * 3);
+            this->ditherer.dither_levels(this->dither_pixels.data(), width, 3, row, this->colour_levels);
+            dithered = this->dither_pixels.data();
+        }
+
         for (int col = 0; col < width; col++)
         {
-            ULONG index = channels * (row * width + col);
+            ULONG index = row * stride + channels * col;
             uchar pixel_b = frame_pixels[index],
-                  pixel_g = frame_pixels[index + 1],
-                  pixel_r = frame_pixels[index + 2];
+                  pixel_g = pixel_b,
+                  pixel_r = pixel_b;
+
+            if (channels >= 3)
+            {
+                pixel_g = frame_pixels[index + 1];
+                pixel_r = frame_pixels[index + 2];
+            }
 
-            char ascii = this->pixel_to_ascii(pixel_r, pixel_g, pixel_b);
+            // grayscale frames already hold the luminance
+            char ascii = (channels == 1) ? this->glyph_lut[pixel_b] : this->pixel_to_ascii(pixel_r, pixel_g, pixel_b);
 
+            chtype attr = A_NORMAL;
             if (this->print_colour)
             {
-                int col_index = TermVideo::get_ncurses_col_index(pixel_r, pixel_g, pixel_b, this->color_step_no);
-                attron(COLOR_PAIR(col_index));
-                mvprintw(row, col + this->padding_x, "%c", ascii);
-                attroff(COLOR_PAIR(col_index));
+                int lut_index = (dithered != nullptr)
+                                    ? get_palette_lut_index(dithered[col * 3 + 2], dithered[col * 3 + 1], dithered[col * 3])
+                                    : get_palette_lut_index(pixel_r, pixel_g, pixel_b);
+                attr = COLOR_PAIR(this->pair_lut[lut_index] + 1);
             }
+            this->row_chars[col] = static_cast<uchar>(ascii) | attr;
         }
-        refresh();
+
+        // only updates the virtual screen, it's flushed to the terminal once per frame
+        mvaddchnstr(row + video_frame.padding_y, video_frame.padding_x, this->row_chars.data(), width);
 #endif
     }
 
-    this->perf_checker.end_frame_time();
-
+    auto write_start = std::chrono::steady_clock::now();
 #if defined(_WIN32)
     WriteConsoleOutputA(this->write_handle, this->buffer, this->buffer_size, {0, 0}, &this->console_write_area);
+#elif defined(__linux__)
+    refresh();
 #endif
+    this->perf_checker.add_write_time(
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - write_start).count());
 }
 
 #if defined(__USE_OPENCV)
@@ -174,94 +215,93 @@ void TermVideo::BufferRenderer::process_video_opencv()
         // reduces video resolution to fit the terminal
         this->frame_downscale_opencv(frame);
 
-        // converts frame into ascii output & prints it out
-        this->frame_to_ascii(frame.data, frame.cols, frame.rows, frame.channels());
-
         // refetch terminal size every interval
         if (frame_count % FETCH_TERMINAL_INTERVAL == 0)
-            this->check_resize();
+            get_terminal_size(this->width, this->height, this->term_resized);
+
+        VideoFrame video_frame;
+        video_frame.pixels = frame.data;
+        video_frame.stride = static_cast<int>(frame.step);
+        video_frame.width = frame.cols;
+        video_frame.height = frame.rows;
+        video_frame.channels = frame.channels();
+        video_frame.term_width = this->width;
+        video_frame.term_height = this->height;
+        video_frame.padding_x = this->padding_x;
+        video_frame.padding_y = this->padding_y;
+
+        // converts frame into ascii output & prints it out
+        this->present_frame(video_frame);
 
         // wait for next interval before processing
         this->wait_for_frame();
     }
 }
-#elif defined(__USE_FFMPEG)
+#endif
+
 /**
- * @brief Converts a video into ASCII frames. Uses FFmpeg
+ * @brief Writes a queued frame into the console buffer. Without ncurses on Linux, the frame's
+ *        cells including their backgrounds are encoded against the cells on the terminal
+ *        by the frame encoder, the same as the terminal renderer
+ *
+ * @param video_frame Frame to be presented
  */
-void TermVideo::BufferRenderer::process_video_ffmpeg()
+void TermVideo::BufferRenderer::present_frame(VideoFrame &video_frame)
 {
-    AVFrame *frame = av_frame_alloc();
-    AVPacket packet;
-
-    int frame_count = 0;
-    int skip_count = 0;
-
-    while (!av_read_frame(this->info->v_format_ctx, &packet))
+#if defined(__linux__)
+    if (!this->use_curses)
     {
-        if (this->info->v_seek.req)
-            this->seek(this->info->v_seek);
-
-        // skips if stream isn't the main video
-        if (packet.stream_index != this->info->v_stream->index)
-        {
-            av_packet_unref(&packet);
-            continue;
-        }
-        // skip if there are issues feeding packet into decoder
-        if (avcodec_send_packet(this->info->v_codec_ctx, &packet))
-        {
-            av_packet_unref(&packet);
-            continue;
-        }
-        // skip if there are issues decoding the packet
-        if (avcodec_receive_frame(this->info->v_codec_ctx, frame))
-        {
-            av_frame_unref(frame);
-            continue;
-        }
-
-        // skip frames by user request
-        if (skip_count++ < this->frames_to_skip)
-            continue;
-        skip_count = 0;
-
-        // keep track of current video time
-        double time_unit = av_q2d(this->info->v_stream->time_base);
-        this->info->v_clock_ms = frame->pts * time_unit * 1000;
+        Renderer::present_frame(video_frame);
+        return;
+    }
+#endif
 
-        // reduces video resolution to fit the terminal
-        this->frame_downscale_ffmpeg(frame);
+    this->check_resize(video_frame);
+    this->frame_to_ascii(video_frame);
+}
 
-        // convert pixels and store to ascii_frame
-        std::string ascii_frame;
-        this->frame_to_ascii(
-            frame->data[0],
-            frame->width, frame->height,
-            this->info->colour_channels);
+/**
+ * @brief Resizes the console buffer if the frame was scaled for a different terminal size
+ *
+ * @param video_frame Frame about to be presented
+ */
+void TermVideo::BufferRenderer::check_resize(const VideoFrame &video_frame)
+{
+    if (this->buffer_width != video_frame.term_width || this->buffer_height != video_frame.term_height)
+        this->resize_buffer(video_frame.term_width, video_frame.term_height);
+}
 
-        av_frame_unref(frame);
-        av_packet_unref(&packet);
+/**
+ * @brief (Re)allocates the console buffer for the given terminal size
+ *
+ * @param width Terminal width in cells
+ * @param height Terminal height in cells
+ */
+void TermVideo::BufferRenderer::resize_buffer(const int width, const int height)
+{
+    this->buffer_width = width;
+    this->buffer_height = height;
 
-        // refetch terminal size every interval
-        if (frame_count % FETCH_TERMINAL_INTERVAL == 0)
-            this->check_resize();
+#if defined(_WIN32)
+    short width_s = static_cast<short>(width - 1),
+          height_s = static_cast<short>(height - 1);
 
-        this->perf_checker.end_frame_time();
-        this->wait_for_frame();
-    }
-}
-#endif
+    delete[] this->buffer;
+    this->buffer = new CHAR_INFO[width * height];
+    this->console_write_area = {0, 0, width_s, height_s};
 
-void TermVideo::BufferRenderer::check_resize()
-{
-    int new_width, new_height;
-    get_terminal_size(new_width, new_height, this->term_resized);
+    this->buffer_size = {static_cast<short>(width), static_cast<short>(height)};
+    SetConsoleScreenBufferSize(this->write_handle, this->buffer_size);
 
-    if (this->width != new_width || this->height != new_height)
+    for (int i = 0; i < (width * height); i++)
     {
-        init_renderer();
+        this->buffer[i].Char.AsciiChar = ' ';
+        this->buffer[i].Attributes = 0;
     }
+#elif defined(__linux__)
+    resizeterm(height, width);
+    erase();
+#endif
 }
 
 /**
@@ -273,29 +313,22 @@ void TermVideo::BufferRenderer::init_renderer()
     set_terminal_title(this->filename);
     hide_terminal_cursor();
     get_terminal_size(this->width, this->height, this->term_resized);
-    init_terminal_col(this->print_colour);
+    init_terminal_col(this->print_colour, this->colour_depth);
 
 #ifdef __USE_OPENCV
     cv::utils::logging::setLogLevel(cv::utils::logging::LogLevel::LOG_LEVEL_SILENT);
 #endif
 
 #if defined(_WIN32)
-    short width_s = static_cast<short>(this->width - 1),
-          height_s = static_cast<short>(this->height - 1);
-
     this->write_handle = GetStdHandle(STD_OUTPUT_HANDLE);
-    this->buffer = new CHAR_INFO[this->width * this->height];
-    this->console_write_area = {0, 0, width_s, height_s};
-
-    this->buffer_size = {static_cast<short>(this->width), static_cast<short>(this->height)};
-    SetConsoleScreenBufferSize(this->write_handle, this->buffer_size);
-
-    for (int i = 0; i < (this->width * this->height); i++)
+#elif defined(__linux__)
+    if (!this->use_curses)
     {
-        this->buffer[i].Char.AsciiChar = ' ';
-        this->buffer[i].Attributes = 0;
+        this->writer.open();
+        this->ready = true;
+        return;
     }
-#elif defined(__linux__)
+
     initscr();
 
     if (this->print_colour)
@@ -312,6 +345,7 @@ void TermVideo::BufferRenderer::init_renderer()
     }
 #endif
 
+    this->resize_buffer(this->width, this->height);
     this->ready = true;
 }
 
@@ -333,15 +367,13 @@ void TermVideo::BufferRenderer::start_renderer()
 #endif
 
     // prints performance after finishing video
-    double avg_time = this->perf_checker.get_avg_frame_time_milli();
-    std::cout << "Average frame time: " << avg_time << "ms" << std::endl;
+    this->print_stats();
 }
 
 #if defined(_WIN32)
 void TermVideo::BufferRenderer::write_to_buffer(const int row, const int col, uchar ascii, WORD attr)
 {
-    this->buffer[row * this->width + col].Char.AsciiChar = ascii;
-    this->buffer[row * this->width + col].Attributes = attr;
+    this->buffer[row * this->buffer_width + col].Char.AsciiChar = ascii;
+    this->buffer[row * this->buffer_width + col].Attributes = attr;
 }
-#elif defined(__linux__)
 #endif
\ No newline at end of file
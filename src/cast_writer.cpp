@@ -0,0 +1,259 @@
+#include "cast_writer.hpp"
+
+namespace TermVideo
+{
+    CastWriter::CastWriter()
+    {
+        this->file = nullptr;
+        this->closing = false;
+        this->write_failed = false;
+        this->events = 0;
+        this->stalls = 0;
+    }
+
+    CastWriter::~CastWriter()
+    {
+        this->close();
+    }
+
+    /**
+     * @brief Creates a .cast file, writes its header and starts the writer thread
+     *
+     * @param path Path of the file
+     * @param width Width of the recorded terminal in cells
+     * @param height Height of the recorded terminal in cells
+     * @param title Title of the recording
+     * @return std::string Error string
+     */
+    std::string CastWriter::open(const std::string &path, int width, int height, const std::string &title)
+    {
+        this->file = fopen(path.c_str(), "wb");
+        if (this->file == nullptr)
+            return "Could not create " + path;
+        setvbuf(this->file, nullptr, _IOFBF, CAST_WRITE_BUFFER);
+
+        const int64_t timestamp = std::chrono::duration_cast<std::chrono::seconds>(
+                                      std::chrono::system_clock::now().time_since_epoch())
+                                      .count();
+
+        std::string header = "{\"version\": 2, \"width\": " + std::to_string(width) + ", \"height\": " + std::to_string(height) +
+                             ", \"timestamp\": " + std::to_string(timestamp) + ", \"title\": ";
+        append_json_string(header, title.data(), title.length());
+        header += "}\n";
+
+        if (fwrite(header.data(), 1, header.length(), this->file) != header.length())
+        {
+            fclose(this->file);
+            this->file = nullptr;
+            return "Could not write to " + path;
+        }
+
+        this->closing = false;
+        this->thread = std::thread(&CastWriter::write_events, this);
+        return "";
+    }
+
+    /**
+     * @brief Queues bytes written to the terminal
+     *
+     * @param time_ms Time since the start of the recording
+     * @param output Bytes of the output, valid UTF-8
+     */
+    void CastWriter::add_output(double time_ms, const std::string &output)
+    {
+        this->add_event(time_ms, 'o', output.data(), output.length());
+    }
+
+    /**
+     * @brief Queues a change of the terminal's size
+     *
+     * @param time_ms Time since the start of the recording
+     * @param width New width in cells
+     * @param height New height in cells
+     */
+    void CastWriter::add_resize(double time_ms, int width, int height)
+    {
+        std::string size = std::to_string(width) + "x" + std::to_string(height);
+        this->add_event(time_ms, 'r', size.data(), size.length());
+    }
+
+    /**
+     * @brief Writes the rest of the queued events and closes the file
+     * @return std::string Error string
+     */
+    std::string CastWriter::close()
+    {
+        if (this->file == nullptr)
+            return "";
+
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->closing = true;
+        }
+        this->cond.notify_all();
+        this->thread.join();
+
+        if (fclose(this->file) != 0)
+            this->write_failed = true;
+        this->file = nullptr;
+
+        return this->write_failed ? "Could not write every event of the recording" : "";
+    }
+
+    uint64_t CastWriter::get_event_count()
+    {
+        return this->events;
+    }
+
+    /**
+     * @brief Number of events that had to wait for the writer thread to catch up
+     */
+    uint64_t CastWriter::get_stalls()
+    {
+        return this->stalls;
+    }
+
+    /**
+     * @brief Appends an event to the queue, waiting only if the queue is full
+     *
+     * @param time_ms Time since the start of the recording
+     * @param type Event type, 'o' for output or 'r' for resize
+     * @param data Data of the event
+     * @param length Bytes of data
+     */
+    void CastWriter::add_event(double time_ms, char type, const char *data, size_t length)
+    {
+        if (this->file == nullptr)
+            return;
+
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            if (this->pending.length() >= CAST_MAX_PENDING_BYTES)
+                this->stalls++;
+
+            this->cond.wait(lock, [this]
+                            { return this->pending.length() < CAST_MAX_PENDING_BYTES; });
+
+            const uint32_t data_length = static_cast<uint32_t>(length);
+            this->pending.append(reinterpret_cast<const char *>(&time_ms), sizeof(time_ms));
+            this->pending.push_back(type);
+            this->pending.append(reinterpret_cast<const char *>(&data_length), sizeof(data_length));
+            this->pending.append(data, length);
+            this->events++;
+        }
+        this->cond.notify_all();
+    }
+
+    /**
+     * @brief Writer thread, takes every queued event at once and writes them as JSON lines
+     *        until the file is closed
+     */
+    void CastWriter::write_events()
+    {
+        while (1)
+        {
+            {
+                std::unique_lock<std::mutex> lock(this->mutex);
+                this->cond.wait(lock, [this]
+                                { return this->closing || this->pending.length() > 0; });
+                if (this->pending.length() == 0)
+                    return;
+
+                // both buffers keep their capacity, so steady recording doesn't allocate
+                this->writing.clear();
+                this->pending.swap(this->writing);
+            }
+            this->cond.notify_all();
+
+            const char *event = this->writing.data();
+            const char *end = event + this->writing.length();
+            while (event < end)
+            {
+                double time_ms;
+                uint32_t length;
+                memcpy(&time_ms, event, sizeof(time_ms));
+                const char type = event[sizeof(time_ms)];
+                memcpy(&length, event + sizeof(time_ms) + 1, sizeof(length));
+                event += sizeof(time_ms) + 1 + sizeof(length);
+
+                this->write_line(time_ms, type, event, length);
+                event += length;
+            }
+        }
+    }
+
+    /**
+     * @brief Writes an event as a line of the file
+     *
+     * @param time_ms Time since the start of the recording
+     * @param type Event type
+     * @param data Data of the event
+     * @param length Bytes of data
+     */
+    void CastWriter::write_line(double time_ms, char type, const char *data, size_t length)
+    {
+        char prefix[48];
+        int prefix_length = snprintf(prefix, sizeof(prefix), "[%.6f, \"%c\", ", time_ms / 1000.0, type);
+
+        this->line.assign(prefix, prefix_length);
+        append_json_string(this->line, data, length);
+        this->line += "]\n";
+
+        if (fwrite(this->line.data(), 1, this->line.length(), this->file) != this->line.length())
+            this->write_failed = true;
+    }
+
+    /**
+     * @brief Appends bytes as a quoted JSON string. Control characters such as the escape
+     *        character are written as \u escapes, other bytes are copied as they are
+     *
+     * @param output String appended to
+     * @param data Bytes to append, valid UTF-8
+     * @param length Number of bytes
+     */
+    void append_json_string(std::string &output, const char *data, size_t length)
+    {
+        static const char hex[] = "0123456789abcdef";
+
+        output.reserve(output.length() + length + length / 4 + 2);
+        output.push_back('"');
+
+        // plain bytes are copied in runs between the ones that need escaping
+        size_t start = 0;
+        for (size_t i = 0; i < length; i++)
+        {
+            const uchar c = static_cast<uchar>(data[i]);
+            if (c >= 0x20 && c != '"' && c != '\\')
+                continue;
+
+            output.append(data + start, i - start);
+            start = i + 1;
+
+            switch (c)
+            {
+            case '"':
+                output += "\\\"";
+                break;
+            case '\\':
+                output += "\\\\";
+                break;
+            case '\n':
+                output += "\\n";
+                break;
+            case '\r':
+                output += "\\r";
+                break;
+            case '\t':
+                output += "\\t";
+                break;
+            default:
+                output += "\\u00";
+                output.push_back(hex[c >> 4]);
+                output.push_back(hex[c & 0x0F]);
+            }
+        }
+
+        output.append(data + start, length - start);
+        output.push_back('"');
+    }
+}
\ No newline at end of file
@@ -0,0 +1,220 @@
+#include "cell_codec.hpp"
+
+namespace TermVideo
+{
+    CellCodec::CellCodec() : CellCodec(false, false, 0) {}
+
+    /**
+     * @brief Construct a new CellCodec object
+     *
+     * @param print_colour Flag whether cells are coloured, otherwise only glyphs are stored
+     * @param use_background Flag whether cells also have a background colour
+     * @param col_threshold Largest difference per channel still considered the same colour
+     */
+    CellCodec::CellCodec(bool print_colour, bool use_background, uchar col_threshold)
+    {
+        this->print_colour = print_colour;
+        this->use_background = print_colour && use_background;
+        this->col_threshold = col_threshold;
+    }
+
+    /**
+     * @brief Compresses a frame against the last one
+     *
+     * @param frame Cells of the frame, row by row
+     * @param width Width of the frame in cells
+     * @param height Height of the frame in cells
+     * @param keyframe Flag whether the frame has to decode without the previous frames
+     * @param output Compressed frame
+     */
+    void CellCodec::encode(const std::vector<Cell> &frame, const int width, const int height, const bool keyframe, std::string &output)
+    {
+        const size_t count = static_cast<size_t>(width) * height;
+        output.clear();
+
+        // nothing to keep after a resize
+        const bool reference = !keyframe && this->cells.size() == count;
+        if (this->cells.size() != count)
+            this->cells.assign(count, {' ', 0, 0, 0, 0, 0, 0, 0, 0});
+
+        for (size_t i = 0; i < count;)
+        {
+            size_t end = i + 1;
+            if (reference && this->is_same_cell(frame[i], this->cells[i]))
+            {
+                while (end < count && this->is_same_cell(frame[end], this->cells[end]))
+                    end++;
+
+                append_varint(output, (end - i) << 1);
+                i = end;
+                continue;
+            }
+
+            // a run goes on over cells the decoder already shows, that's cheaper than
+            // breaking it with an operation keeping them
+            const Cell &cell = frame[i];
+            while (end < count && this->is_same_cell(frame[end], cell))
+                end++;
+
+            append_varint(output, ((end - i) << 1) | 1);
+            this->append_cell(output, cell);
+            for (; i < end; i++)
+                this->cells[i] = cell;
+        }
+    }
+
+    /**
+     * @brief Applies a compressed frame to the cells of the last one
+     *
+     * @param data Compressed frame
+     * @param length Bytes of the compressed frame
+     * @param width Width of the frame in cells
+     * @param height Height of the frame in cells
+     * @return bool False if the frame is malformed
+     */
+    bool CellCodec::decode(const char *data, size_t length, const int width, const int height)
+    {
+        const size_t count = static_cast<size_t>(width) * height;
+        if (this->cells.size() != count)
+            this->cells.assign(count, {' ', 0, 0, 0, 0, 0, 0, 0, 0});
+
+        const uchar *read = reinterpret_cast<const uchar *>(data),
+                    *end = read + length;
+        size_t i = 0;
+
+        while (i < count)
+        {
+            uint64_t op;
+            if (!read_varint(read, end, op) || (op >> 1) > count - i)
+                return false;
+
+            const size_t run = op >> 1;
+            if (!(op & 1))
+            {
+                i += run;
+                continue;
+            }
+
+            Cell cell;
+            if (!this->read_cell(read, end, cell))
+                return false;
+
+            std::fill(this->cells.begin() + i, this->cells.begin() + i + run, cell);
+            i += run;
+        }
+
+        return read == end;
+    }
+
+    /**
+     * @brief Cells the decoder has after the last frame, also what the encoder compared against
+     */
+    const std::vector<Cell> &CellCodec::get_cells()
+    {
+        return this->cells;
+    }
+
+    /**
+     * @brief Checks whether 2 cells look the same once stored, within the colour threshold
+     */
+    bool CellCodec::is_same_cell(const Cell &cell, const Cell &other)
+    {
+        if (cell.glyph != other.glyph)
+            return false;
+        if (!this->print_colour)
+            return true;
+
+        const int threshold = this->col_threshold;
+        if (abs(cell.r - other.r) > threshold || abs(cell.g - other.g) > threshold || abs(cell.b - other.b) > threshold)
+            return false;
+
+        return !this->use_background ||
+               (abs(cell.bg_r - other.bg_r) <= threshold && abs(cell.bg_g - other.bg_g) <= threshold &&
+                abs(cell.bg_b - other.bg_b) <= threshold);
+    }
+
+    /**
+     * @brief Appends a cell as its glyph followed by the colours that are stored
+     */
+    void CellCodec::append_cell(std::string &output, const Cell &cell)
+    {
+        append_varint(output, cell.glyph);
+        if (!this->print_colour)
+            return;
+
+        const char colours[6] = {static_cast<char>(cell.r), static_cast<char>(cell.g), static_cast<char>(cell.b),
+                                 static_cast<char>(cell.bg_r), static_cast<char>(cell.bg_g), static_cast<char>(cell.bg_b)};
+        output.append(colours, this->use_background ? 6 : 3);
+    }
+
+    /**
+     * @brief Reads a cell written by append_cell
+     *
+     * @return bool False if the data ends first
+     */
+    bool CellCodec::read_cell(const uchar *&read, const uchar *end, Cell &cell)
+    {
+        uint64_t glyph;
+        if (!read_varint(read, end, glyph))
+            return false;
+
+        cell = {static_cast<uint32_t>(glyph), 0, 0, 0, 0, 0, 0, 0, 0};
+        if (!this->print_colour)
+            return true;
+
+        const int colour_bytes = this->use_background ? 6 : 3;
+        if (end - read < colour_bytes)
+            return false;
+
+        cell.r = read[0];
+        cell.g = read[1];
+        cell.b = read[2];
+        if (this->use_background)
+        {
+            cell.bg_r = read[3];
+            cell.bg_g = read[4];
+            cell.bg_b = read[5];
+        }
+
+        read += colour_bytes;
+        return true;
+    }
+
+    /**
+     * @brief Appends an unsigned integer 7 bits per byte, the high bit set on all but the last
+     *
+     * @param output String to append to
+     * @param value Value to be appended
+     */
+    void append_varint(std::string &output, uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            output += static_cast<char>((value & 0x7F) | 0x80);
+            value >>= 7;
+        }
+        output += static_cast<char>(value);
+    }
+
+    /**
+     * @brief Reads an unsigned integer written by append_varint
+     *
+     * @param read Position to read from, moved past the value
+     * @param end End of the data
+     * @param value Value read
+     * @return bool False if the data ends first or the value is too long
+     */
+    bool read_varint(const uchar *&read, const uchar *end, uint64_t &value)
+    {
+        value = 0;
+        for (int shift = 0; shift < 64 && read < end; shift += 7)
+        {
+            uchar byte = *read++;
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80))
+                return true;
+        }
+
+        return false;
+    }
+}
\ No newline at end of file
@@ -45,7 +45,8 @@ WORD TermVideo::get_win32_col(uchar r, uchar g, uchar b)
 
 #if defined(__linux__)
 /**
- * @brief Returns an index closest to the one set automatically
+ * @brief Returns an index closest to the one set automatically. Replaced by the colour pair
+ *        lookup table, kept as the baseline it's benchmarked against
  *
  * @param r Redness value (0-255)
  * @param g Greenness value (0-255)
@@ -98,4 +99,136 @@ std::string TermVideo::get_char_ansi_col(uchar r, uchar g, uchar b, std::string
     {
         return std::string(c, 1);
     }
+}
+
+/**
+ * @brief RGB values of a palette, wrapped so it can be built at compile time
+ */
+struct PaletteColours
+{
+    uchar colours[256][3];
+};
+
+// xterm's 6x6x6 colour cube & grayscale ramp, the first 16 colours are left black
+static constexpr PaletteColours xterm256_palette = []
+{
+    const uchar levels[6] = {0, 95, 135, 175, 215, 255};
+    PaletteColours palette{};
+
+    for (int i = 0; i < 216; i++)
+    {
+        palette.colours[16 + i][0] = levels[i / 36];
+        palette.colours[16 + i][1] = levels[i / 6 % 6];
+        palette.colours[16 + i][2] = levels[i % 6];
+    }
+    for (int i = 0; i < 24; i++)
+        palette.colours[232 + i][0] = palette.colours[232 + i][1] = palette.colours[232 + i][2] = static_cast<uchar>(8 + i * 10);
+
+    return palette;
+}();
+
+// xterm's default 16 colours
+static constexpr uchar ansi16_palette[16][3] = {
+    {0, 0, 0}, {205, 0, 0}, {0, 205, 0}, {205, 205, 0},
+    {0, 0, 238}, {205, 0, 205}, {0, 205, 205}, {229, 229, 229},
+    {127, 127, 127}, {255, 0, 0}, {0, 255, 0}, {255, 255, 0},
+    {92, 92, 255}, {255, 0, 255}, {0, 255, 255}, {255, 255, 255}};
+
+/**
+ * @brief Builds a lookup table from 15 bit RGB to the nearest colour of a palette
+ *
+ * @param palette RGB values of the palette
+ * @param first Index of the first palette entry that can be picked
+ * @param end One past the index of the last palette entry that can be picked
+ * @param perceptual Flag whether to weigh the channels by how visible their differences are,
+ *                   using the "redmean" approximation, instead of the plain RGB distance
+ * @return std::vector<uchar> Palette index for every 15 bit RGB value
+ */
+static std::vector<uchar> build_palette_lut(const uchar (*palette)[3], int first, int end, bool perceptual = false)
+{
+    const int levels = 1 << PALETTE_LUT_BITS,
+              shift = 8 - PALETTE_LUT_BITS;
+    std::vector<uchar> lut(levels * levels * levels);
+
+    for (int i = 0; i < static_cast<int>(lut.size()); i++)
+    {
+        // centre of the range of colours truncated into this entry
+        int r = ((i >> (2 * PALETTE_LUT_BITS)) << shift) | (1 << (shift - 1)),
+            g = (((i >> PALETTE_LUT_BITS) & (levels - 1)) << shift) | (1 << (shift - 1)),
+            b = ((i & (levels - 1)) << shift) | (1 << (shift - 1));
+
+        int best_index = first, best_dist = INT32_MAX;
+        for (int p = first; p < end; p++)
+        {
+            int dr = r - palette[p][0], dg = g - palette[p][1], db = b - palette[p][2];
+            int dist = dr * dr + dg * dg + db * db;
+            if (perceptual)
+            {
+                int r_mean = (r + palette[p][0]) / 2;
+                dist = (((512 + r_mean) * dr * dr) >> 8) + 4 * dg * dg + (((767 - r_mean) * db * db) >> 8);
+            }
+            if (dist < best_dist)
+            {
+                best_dist = dist;
+                best_index = p;
+            }
+        }
+
+        lut[i] = static_cast<uchar>(best_index);
+    }
+
+    return lut;
+}
+
+/**
+ * @brief Returns the closest colour of the xterm 256 colour palette, only the 6x6x6 cube and
+ *        the grayscale ramp are used as the first 16 colours differ between terminals
+ *
+ * @param r Redness value (0-255)
+ * @param g Greenness value (0-255)
+ * @param b Blueness value (0-255)
+ * @return uchar Palette index (16-255)
+ */
+uchar TermVideo::get_xterm256_index(uchar r, uchar g, uchar b)
+{
+    static const std::vector<uchar> lut = build_palette_lut(xterm256_palette.colours, 16, 256);
+    return lut[get_palette_lut_index(r, g, b)];
+}
+
+/**
+ * @brief Returns the closest colour of the 16 standard ANSI colours, using xterm's defaults
+ *
+ * @param r Redness value (0-255)
+ * @param g Greenness value (0-255)
+ * @param b Blueness value (0-255)
+ * @return uchar Colour index, 0-7 for normal and 8-15 for bright colours
+ */
+uchar TermVideo::get_ansi16_index(uchar r, uchar g, uchar b)
+{
+    static const std::vector<uchar> lut = build_palette_lut(ansi16_palette, 0, 16);
+    return lut[get_palette_lut_index(r, g, b)];
+}
+
+/**
+ * @brief Returns the RGB values of a palette colour
+ *
+ * @param index Palette index, 16-255 for 256 colours or 0-15 for 16 colours
+ * @param colour_depth Either 256 or 16
+ * @return const uchar* Red, green & blue values
+ */
+const uchar *TermVideo::get_palette_colour(uchar index, int colour_depth)
+{
+    return (colour_depth == 256) ? xterm256_palette.colours[index] : ansi16_palette[index & 15];
+}
+
+/**
+ * @brief Builds a lookup table from 15 bit RGB to the perceptually nearest of a set of
+ *        colours, such as the colours of the initialised ncurses colour pairs
+ *
+ * @param colours RGB values packed 3 bytes per colour, at most 256 colours
+ * @return std::vector<uchar> Index of the nearest colour for every 15 bit RGB value
+ */
+std::vector<uchar> TermVideo::build_colour_pair_lut(const std::vector<uchar> &colours)
+{
+    return build_palette_lut(reinterpret_cast<const uchar(*)[3]>(colours.data()), 0, static_cast<int>(colours.size() / 3), true);
 }
\ No newline at end of file
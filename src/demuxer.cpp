@@ -0,0 +1,225 @@
+#include "demuxer.hpp"
+
+namespace TermVideo
+{
+    PacketQueue::PacketQueue()
+    {
+        this->serial = 0;
+        this->closed = false;
+    }
+
+    PacketQueue::~PacketQueue()
+    {
+        for (AVPacket *packet : this->packets)
+            av_packet_free(&packet);
+    }
+
+    /**
+     * @brief Moves a packet into the queue
+     * @param packet Packet to be queued, left blank afterwards
+     */
+    void PacketQueue::put(AVPacket *packet)
+    {
+        AVPacket *queued = av_packet_alloc();
+        av_packet_move_ref(queued, packet);
+
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->packets.push_back(queued);
+        }
+        this->cond.notify_all();
+    }
+
+    /**
+     * @brief Waits for the next packet in the queue
+     * @param packet Packet to move the queued packet into
+     * @param serial Serial of the queue when the packet was taken
+     * @return int 1 if a packet was taken, 0 once the stream has ended
+     */
+    int PacketQueue::get(AVPacket *packet, int &serial)
+    {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        this->cond.wait(lock, [this]
+                        { return this->closed || !this->packets.empty(); });
+        if (this->packets.empty())
+            return 0;
+
+        AVPacket *queued = this->packets.front();
+        this->packets.pop_front();
+        av_packet_move_ref(packet, queued);
+        av_packet_free(&queued);
+
+        serial = this->serial;
+        return 1;
+    }
+
+    /**
+     * @brief Drops every queued packet, used when seeking
+     */
+    void PacketQueue::flush()
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        for (AVPacket *packet : this->packets)
+            av_packet_free(&packet);
+
+        this->packets.clear();
+        this->serial++;
+    }
+
+    /**
+     * @brief Marks the end of the stream, get returns 0 once the queue is drained
+     */
+    void PacketQueue::close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->closed = true;
+        }
+        this->cond.notify_all();
+    }
+
+    size_t PacketQueue::size()
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        return this->packets.size();
+    }
+
+    int PacketQueue::get_serial()
+    {
+        return this->serial;
+    }
+
+    Demuxer::Demuxer(MediaInfo *info)
+    {
+        this->info = info;
+        this->info->format_ctx = nullptr;
+        this->info->v_packets = nullptr;
+        this->info->a_packets = nullptr;
+        this->stopped = false;
+    }
+
+    Demuxer::~Demuxer()
+    {
+        delete this->info->v_packets;
+        delete this->info->a_packets;
+        avformat_close_input(&this->info->format_ctx);
+    }
+
+    /**
+     * @brief Opens the media file shared by the audio player & renderer
+     * @param filename Path of the media file
+     * @return std::string Error string
+     */
+    std::string Demuxer::open_file(std::string filename)
+    {
+        int ret = avformat_open_input(&this->info->format_ctx, filename.c_str(), nullptr, nullptr);
+        if (ret < 0)
+            return "Unable to open media file!";
+
+        ret = avformat_find_stream_info(this->info->format_ctx, nullptr);
+        if (ret < 0)
+            return "Unable to find stream info!";
+
+        return "";
+    }
+
+    /**
+     * @brief Creates packet queues for the streams picked by the renderer & audio player,
+     *        every other stream is discarded before it's parsed
+     */
+    void Demuxer::init_queues()
+    {
+        if (this->info->v_stream)
+            this->info->v_packets = new PacketQueue();
+        if (this->info->a_stream)
+            this->info->a_packets = new PacketQueue();
+
+        for (size_t i = 0; i < this->info->format_ctx->nb_streams; ++i)
+        {
+            AVStream *stream = this->info->format_ctx->streams[i];
+            if (stream != this->info->v_stream && stream != this->info->a_stream)
+                stream->discard = AVDISCARD_ALL;
+        }
+    }
+
+    /**
+     * @brief Reads packets from the file and routes them to their stream's queue
+     *        until the end of the file or stop is called
+     */
+    void Demuxer::demux()
+    {
+        AVPacket *packet = av_packet_alloc();
+
+        while (!this->stopped)
+        {
+            if (this->info->seek.req)
+                this->seek(this->info->seek);
+
+            // let the decoders catch up instead of reading the whole file into memory
+            if (this->queues_full())
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                continue;
+            }
+
+            int ret = av_read_frame(this->info->format_ctx, packet);
+            if (ret < 0)
+                break;
+
+            if (this->info->v_packets && packet->stream_index == this->info->v_stream->index)
+                this->info->v_packets->put(packet);
+            else if (this->info->a_packets && packet->stream_index == this->info->a_stream->index)
+                this->info->a_packets->put(packet);
+            else
+                av_packet_unref(packet);
+        }
+
+        this->close_queues();
+        av_packet_free(&packet);
+    }
+
+    /**
+     * @brief Stops demuxing, decoders waiting on packets are woken up and finish
+     */
+    void Demuxer::stop()
+    {
+        this->stopped = true;
+        this->close_queues();
+    }
+
+    /**
+     * @brief Seeks the file once for both streams and drops the packets queued before it
+     * @param seek_info Seek position in milliseconds and flags
+     */
+    void Demuxer::seek(Seek seek_info)
+    {
+        // without a stream index, timestamps are in AV_TIME_BASE (microseconds)
+        int64_t timestamp = static_cast<int64_t>(seek_info.pos * 1000);
+        if (timestamp < 0)
+            timestamp = 0;
+
+        av_seek_frame(this->info->format_ctx, -1, timestamp, seek_info.flags);
+
+        if (this->info->v_packets)
+            this->info->v_packets->flush();
+        if (this->info->a_packets)
+            this->info->a_packets->flush();
+
+        this->info->seek.req = false;
+    }
+
+    bool Demuxer::queues_full()
+    {
+        bool v_full = !this->info->v_packets || this->info->v_packets->size() >= PACKET_QUEUE_SOFT_LIMIT;
+        bool a_full = !this->info->a_packets || this->info->a_packets->size() >= PACKET_QUEUE_SOFT_LIMIT;
+        return v_full && a_full;
+    }
+
+    void Demuxer::close_queues()
+    {
+        if (this->info->v_packets)
+            this->info->v_packets->close();
+        if (this->info->a_packets)
+            this->info->a_packets->close();
+    }
+}
\ No newline at end of file
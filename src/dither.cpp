@@ -0,0 +1,216 @@
+#include "dither.hpp"
+
+namespace TermVideo
+{
+    /**
+     * @brief Bayer threshold matrix, every value from 0 to BAYER_SIZE^2 - 1 appears once
+     */
+    struct BayerMatrix
+    {
+        uchar thresholds[BAYER_SIZE][BAYER_SIZE];
+    };
+
+    static constexpr BayerMatrix bayer_matrix = []
+    {
+        BayerMatrix matrix{};
+
+        // each doubling places 4 copies of the smaller matrix, offset by 0, 2, 3 & 1
+        for (int size = 1; size < BAYER_SIZE; size *= 2)
+        {
+            for (int y = 0; y < size; y++)
+                for (int x = 0; x < size; x++)
+                {
+                    const int value = matrix.thresholds[y][x] * 4;
+                    matrix.thresholds[y][x] = static_cast<uchar>(value);
+                    matrix.thresholds[y][x + size] = static_cast<uchar>(value + 2);
+                    matrix.thresholds[y + size][x] = static_cast<uchar>(value + 3);
+                    matrix.thresholds[y + size][x + size] = static_cast<uchar>(value + 1);
+                }
+        }
+
+        return matrix;
+    }();
+
+    Ditherer::Ditherer()
+    {
+        this->mode = DitherMode::None;
+        this->bayer_length = this->bayer_channels = this->bayer_amplitude = 0;
+        this->last_row = -1;
+    }
+
+    bool Ditherer::is_valid_mode(std::string mode)
+    {
+        return mode == "none" || mode == "bayer" || mode == "fs";
+    }
+
+    /**
+     * @brief Sets the dithering used for every following row
+     * @param mode One of none, bayer or fs
+     */
+    void Ditherer::set_mode(std::string mode)
+    {
+        if (mode == "bayer")
+            this->mode = DitherMode::Bayer;
+        else if (mode == "fs")
+            this->mode = DitherMode::FloydSteinberg;
+        else
+            this->mode = DitherMode::None;
+    }
+
+    bool Ditherer::is_enabled()
+    {
+        return this->mode != DitherMode::None;
+    }
+
+    /**
+     * @brief Dithers a row of values that are about to be split into evenly sized levels,
+     *        such as luminance mapped onto a character set
+     *
+     * @param values Values of the row, interleaved when there's more than 1 channel. Dithered in place
+     * @param count Number of pixels in the row
+     * @param channels Values per pixel, each channel is dithered separately
+     * @param row Row of the frame, starting from 0
+     * @param levels Number of levels the values are split into
+     */
+    void Ditherer::dither_levels(uchar *values, int count, int channels, int row, int levels)
+    {
+        if (this->mode == DitherMode::None || levels < 2)
+            return;
+
+        const int length = count * channels;
+
+        if (this->mode == DitherMode::Bayer)
+        {
+            this->build_bayer_rows(length, channels, 256 / levels);
+            const int offset = (row % BAYER_SIZE) * length;
+            get_kernels().offset_row(values, &this->bayer_add[offset], &this->bayer_sub[offset], length, values);
+            return;
+        }
+
+        this->prepare_errors(row, length + 2 * channels);
+        int *current = this->errors[row & 1].data() + channels,
+            *next = this->errors[(row + 1) & 1].data() + channels;
+
+        for (int i = 0; i < length; i++)
+        {
+            int value = std::clamp(values[i] + current[i] / 16, 0, 255);
+
+            // middle of the level, so it maps back onto the same level
+            int level = std::min(value * levels / 255, levels - 1);
+            int quantised = (2 * level + 1) * 255 / (2 * levels);
+            values[i] = static_cast<uchar>(quantised);
+
+            int error = value - quantised;
+            current[i + channels] += error * 7;
+            next[i - channels] += error * 3;
+            next[i] += error * 5;
+            next[i + channels] += error;
+        }
+    }
+
+    /**
+     * @brief Picks the palette colour of every pixel in a row, dithering the difference
+     *        between each pixel & its palette colour
+     *
+     * @param bgr Packed BGR24 pixels of the row, used as scratch space
+     * @param count Number of pixels in the row
+     * @param row Row of the frame, starting from 0
+     * @param colour_depth Either 256 or 16
+     * @param indices Output palette index per pixel
+     */
+    void Ditherer::dither_palette(uchar *bgr, int count, int row, int colour_depth, uchar *indices)
+    {
+        auto palette_index = (colour_depth == 256) ? get_xterm256_index : get_ansi16_index;
+
+        if (this->mode == DitherMode::FloydSteinberg)
+        {
+            this->prepare_errors(row, (count + 2) * 3);
+            int *current = this->errors[row & 1].data() + 3,
+                *next = this->errors[(row + 1) & 1].data() + 3;
+
+            for (int i = 0; i < count * 3; i += 3)
+            {
+                int b = std::clamp(bgr[i] + current[i] / 16, 0, 255),
+                    g = std::clamp(bgr[i + 1] + current[i + 1] / 16, 0, 255),
+                    r = std::clamp(bgr[i + 2] + current[i + 2] / 16, 0, 255);
+
+                uchar index = palette_index(r, g, b);
+                const uchar *rgb = get_palette_colour(index, colour_depth);
+                indices[i / 3] = index;
+
+                const int channel_errors[3] = {b - rgb[2], g - rgb[1], r - rgb[0]};
+                for (int c = 0; c < 3; c++)
+                {
+                    current[i + 3 + c] += channel_errors[c] * 7;
+                    next[i - 3 + c] += channel_errors[c] * 3;
+                    next[i + c] += channel_errors[c] * 5;
+                    next[i + 3 + c] += channel_errors[c];
+                }
+            }
+            return;
+        }
+
+        if (this->mode == DitherMode::Bayer)
+        {
+            // roughly the distance between neighbouring levels of the palette
+            this->build_bayer_rows(count * 3, 3, (colour_depth == 256) ? 51 : 128);
+            const int offset = (row % BAYER_SIZE) * count * 3;
+            get_kernels().offset_row(bgr, &this->bayer_add[offset], &this->bayer_sub[offset], count * 3, bgr);
+        }
+
+        for (int i = 0; i < count; i++)
+            indices[i] = palette_index(bgr[i * 3 + 2], bgr[i * 3 + 1], bgr[i * 3]);
+    }
+
+    /**
+     * @brief Builds the Bayer offsets for every row of the matrix, unless they were
+     *        already built for the same row length & amplitude
+     *
+     * @param length Number of values in a row
+     * @param channels Values per pixel, all channels of a pixel share the same offset
+     * @param amplitude Distance between levels, offsets span half of it either way
+     */
+    void Ditherer::build_bayer_rows(int length, int channels, int amplitude)
+    {
+        amplitude = std::min(amplitude, 255);
+        if (length == this->bayer_length && channels == this->bayer_channels && amplitude == this->bayer_amplitude)
+            return;
+
+        this->bayer_length = length;
+        this->bayer_channels = channels;
+        this->bayer_amplitude = amplitude;
+        this->bayer_add.resize(BAYER_SIZE * length);
+        this->bayer_sub.resize(BAYER_SIZE * length);
+
+        for (int y = 0; y < BAYER_SIZE; y++)
+        {
+            for (int i = 0; i < length; i++)
+            {
+                const int threshold = bayer_matrix.thresholds[y][(i / channels) % BAYER_SIZE];
+                const int offset = (2 * threshold + 1) * amplitude / (2 * BAYER_SIZE * BAYER_SIZE) - amplitude / 2;
+
+                this->bayer_add[y * length + i] = static_cast<uchar>(std::max(offset, 0));
+                this->bayer_sub[y * length + i] = static_cast<uchar>(std::max(-offset, 0));
+            }
+        }
+    }
+
+    /**
+     * @brief Clears the errors carried into the next row, or both rows when a new frame
+     *        starts or the row length changes
+     *
+     * @param row Row about to be dithered
+     * @param length Number of errors per row, including 1 pixel of padding either side
+     */
+    void Ditherer::prepare_errors(int row, int length)
+    {
+        std::vector<int> &current = this->errors[row & 1],
+                         &next = this->errors[(row + 1) & 1];
+
+        if (row != this->last_row + 1 || static_cast<int>(current.size()) != length)
+            current.assign(length, 0);
+        next.assign(length, 0);
+
+        this->last_row = row;
+    }
+}
\ No newline at end of file
@@ -12,4 +12,174 @@ void TermVideo::save_ascii_to_file(const std::string filepath, const std::string
     file.open(filepath);
     file << ascii;
     file.close();
+}
+
+/**
+ * @brief Construct a new ExportRenderer object
+ *
+ * @param info Media being exported
+ * @param opts Options, the export path & grid size are used instead of the terminal
+ */
+TermVideo::ExportRenderer::ExportRenderer(MediaInfo *info, Options opts)
+    : Renderer(info, opts)
+{
+    this->export_path = opts.export_path;
+    this->dither = opts.dither;
+    this->compress = opts.compress_export;
+    this->use_background = this->render_mode == RenderMode::HalfBlock || this->render_mode == RenderMode::Space;
+    this->codec = CellCodec(this->print_colour, this->use_background, this->col_threshold);
+    this->grid_width = opts.grid_width;
+    this->grid_height = opts.grid_height;
+    this->last_keyframe_ms = 0;
+    this->write_failed = false;
+    this->fixed_size = true;
+}
+
+/**
+ * @brief Creates the .tvid file, the grid defaults to the terminal's size
+ */
+void TermVideo::ExportRenderer::init_renderer()
+{
+    get_terminal_size(this->width, this->height, this->term_resized);
+    if (this->grid_width > 0 && this->grid_height > 0)
+    {
+        this->width = this->grid_width;
+        this->height = this->grid_height;
+    }
+
+    // compressed cells are encoded on playback, with the same settings as they would be now
+    TvidHeader header = {};
+    header.width = this->width;
+    header.height = this->height;
+    header.colour_depth = this->colour_depth;
+    header.flags = (this->print_colour ? TVID_FLAG_COLOUR : 0) | (this->use_background ? TVID_FLAG_BACKGROUND : 0);
+    header.codec = this->compress ? TVID_CODEC_CELLS : TVID_CODEC_TERMINAL;
+    header.col_threshold = this->col_threshold;
+    header.colour_budget = this->colour_budget;
+    strncpy(header.dither, this->dither.c_str(), sizeof(header.dither) - 1);
+
+    std::string res = this->tvid.open(this->export_path, header);
+    if (res.length() > 0)
+    {
+        std::cerr << res << std::endl;
+        this->ready = false;
+        return;
+    }
+
+    this->ready = true;
+}
+
+/**
+ * @brief Renders every frame into the file, then writes its index
+ */
+void TermVideo::ExportRenderer::start_renderer()
+{
+    if (!this->ready)
+        return;
+
+#if defined(__USE_FFMPEG)
+    this->process_video_ffmpeg();
+#endif
+
+    std::string res = this->tvid.close(this->info->frametime_ns);
+    if (this->write_failed || res.length() > 0)
+    {
+        std::cerr << (res.length() > 0 ? res : "Could not write every frame to " + this->export_path) << std::endl;
+        return;
+    }
+
+    std::cout << this->decoder_summary << std::endl;
+    std::cout << "Exported " << this->tvid.get_frame_count() << " frames (" << this->tvid.get_keyframe_count()
+              << " keyframes) at " << this->width << "x" << this->height << " to " << this->export_path << std::endl;
+    std::cout << "Average output: " << this->perf_checker.get_avg_frame_bytes() << " bytes/frame"
+              << ", average frame time: " << this->perf_checker.get_avg_frame_time_milli() << "ms" << std::endl;
+}
+
+/**
+ * @brief Encodes a frame and appends it to the file. A keyframe is forced every
+ *        TVID_KEYFRAME_INTERVAL_MS so playback can seek without replaying the whole video
+ *
+ * @param video_frame Frame to be exported
+ */
+void TermVideo::ExportRenderer::present_frame(VideoFrame &video_frame)
+{
+    bool keyframe = this->tvid.get_frame_count() == 0 || video_frame.pts_ms - this->last_keyframe_ms >= TVID_KEYFRAME_INTERVAL_MS ||
+                    video_frame.pts_ms < this->last_keyframe_ms;
+
+    if (this->compress)
+    {
+        this->frame_to_cells(video_frame);
+        this->codec.encode(this->cells, video_frame.term_width, video_frame.term_height, keyframe, this->frame_output);
+    }
+    else
+    {
+        if (keyframe)
+            this->encoder.force_full_repaint();
+
+        // a frame is only a keyframe when every band of it was repainted
+        uint64_t full_frames = this->encoder.get_full_frames();
+        this->frame_to_ascii(this->frame_output, video_frame);
+        keyframe = this->encoder.get_full_frames() != full_frames;
+    }
+
+    if (keyframe)
+        this->last_keyframe_ms = video_frame.pts_ms;
+
+    if (!this->tvid.add_frame(this->frame_output, video_frame.pts_ms, keyframe))
+        this->write_failed = true;
+    this->perf_checker.add_frame_bytes(this->frame_output.length());
+}
+
+/**
+ * @brief Construct a new HeadlessRenderer object
+ *
+ * @param info Media being recorded
+ * @param opts Options, the record path & grid size are used instead of the terminal
+ */
+TermVideo::HeadlessRenderer::HeadlessRenderer(MediaInfo *info, Options opts)
+    : Renderer(info, opts)
+{
+    this->width = opts.grid_width > 0 ? opts.grid_width : HEADLESS_DEFAULT_WIDTH;
+    this->height = opts.grid_height > 0 ? opts.grid_height : HEADLESS_DEFAULT_HEIGHT;
+    this->term_resized = true;
+    this->fixed_size = true;
+}
+
+/**
+ * @brief Starts the recording, nothing is written to the terminal
+ */
+void TermVideo::HeadlessRenderer::init_renderer()
+{
+    this->ready = true;
+    this->open_recording();
+}
+
+/**
+ * @brief Renders every frame into the recording
+ */
+void TermVideo::HeadlessRenderer::start_renderer()
+{
+    if (!this->ready)
+        return;
+
+#if defined(__USE_FFMPEG)
+    this->process_video_ffmpeg();
+#endif
+
+    this->close_recording();
+    std::cout << this->decoder_summary << std::endl;
+    std::cout << "Average output: " << this->perf_checker.get_avg_frame_bytes() << " bytes/frame"
+              << ", average frame time: " << this->perf_checker.get_avg_frame_time_milli() << "ms" << std::endl;
+}
+
+/**
+ * @brief Encodes a frame and queues it in the recording
+ *
+ * @param video_frame Frame to be recorded
+ */
+void TermVideo::HeadlessRenderer::present_frame(VideoFrame &video_frame)
+{
+    this->frame_to_ascii(this->frame_output, video_frame);
+    this->record_frame(video_frame);
+    this->perf_checker.add_frame_bytes(this->frame_output.length());
 }
\ No newline at end of file
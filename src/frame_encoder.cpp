@@ -0,0 +1,750 @@
+#include "frame_encoder.hpp"
+
+namespace TermVideo
+{
+    /**
+     * @brief Decimal text of a byte, so escapes are assembled without formatting numbers
+     */
+    struct DecimalText
+    {
+        char text[3];
+        uchar length;
+    };
+
+    static constexpr std::array<DecimalText, 256> decimal_table = []
+    {
+        std::array<DecimalText, 256> table{};
+        for (int i = 0; i < 256; i++)
+        {
+            DecimalText &entry = table[i];
+            if (i >= 100)
+                entry = {{static_cast<char>('0' + i / 100), static_cast<char>('0' + i / 10 % 10), static_cast<char>('0' + i % 10)}, 3};
+            else if (i >= 10)
+                entry = {{static_cast<char>('0' + i / 10), static_cast<char>('0' + i % 10), 0}, 2};
+            else
+                entry = {{static_cast<char>('0' + i), 0, 0}, 1};
+        }
+        return table;
+    }();
+
+    FrameEncoder::FrameEncoder() : FrameEncoder(false, 0, false, 24, false, 0, "none") {}
+
+    /**
+     * @brief Construct a new FrameEncoder object
+     *
+     * @param print_colour Flag whether to print coloured characters
+     * @param col_threshold Threshold to use the previous colour set
+     * @param use_delta Flag whether to only redraw cells changed since the last frame
+     * @param colour_depth Colours used for output, 24 (RGB), 256 or 16
+     * @param use_background Flag whether cells also set their background colour
+     * @param colour_budget Largest perceptual colour error when merging RGB foregrounds into runs, 0 to disable
+     * @param dither Dithering of 256 & 16 colour output, none, bayer or fs
+     */
+    FrameEncoder::FrameEncoder(bool print_colour, uchar col_threshold, bool use_delta, int colour_depth, bool use_background,
+                               int colour_budget, std::string dither)
+    {
+        this->fg_ditherer.set_mode(dither);
+        this->bg_ditherer.set_mode(dither);
+        this->budget_optimiser = BudgetOptimiser(col_threshold, colour_budget);
+        this->use_budget = print_colour && colour_budget > 0;
+        this->print_colour = print_colour;
+        this->col_threshold = col_threshold;
+        this->use_delta = use_delta;
+        this->colour_depth = colour_depth;
+        this->use_background = print_colour && use_background;
+        this->full_repaint = true;
+        this->screen_width = this->screen_height = 0;
+        this->worker_pool = nullptr;
+        this->full_frames = this->delta_frames = 0;
+    }
+
+    /**
+     * @brief Encodes a frame of cells in bands of rows, each band as a delta against the
+     *        screen when it's smaller than redrawing the band
+     *
+     * @param cells Cells of the frame, row by row. Palette indices are filled in for 256 & 16 colours,
+     *              RGB foregrounds are merged into runs when a colour budget is set
+     * @param width Width of the frame in cells
+     * @param height Height of the frame in cells
+     * @param output Bytes to be written to the terminal
+     */
+    void FrameEncoder::encode(std::vector<Cell> &cells, const int width, const int height, std::string &output)
+    {
+        output.clear();
+
+        // previous frame is meaningless after a resize
+        if (width != this->screen_width || height != this->screen_height)
+        {
+            this->screen.assign(cells.size(), {' ', 0, 0, 0, 0, 0, 0, 0, 0});
+            this->screen_rgb.assign(cells.size() * 3, 0);
+            this->row_rgb.resize(width * 3);
+            this->row_palette.resize(width);
+            this->bands.resize((height + ENCODE_BAND_ROWS - 1) / ENCODE_BAND_ROWS);
+            for (EncoderBand &band : this->bands)
+            {
+                band.row_rgb.resize(width * 3);
+                band.row_changed.resize(width);
+                band.last_full_bytes = 0;
+            }
+            this->screen_width = width;
+            this->screen_height = height;
+            this->full_repaint = true;
+        }
+
+        this->quantise(cells, width, height);
+        if (this->use_budget && this->colour_depth == 24)
+            this->budget_optimiser.optimise(cells, width, height);
+
+        const bool repaint = !this->use_delta || this->full_repaint;
+        const int band_count = static_cast<int>(this->bands.size());
+        auto encode_band = [&](int index)
+        { this->encode_band(cells, index, repaint); };
+
+        if (this->worker_pool != nullptr)
+            this->worker_pool->run(band_count, encode_band);
+        else
+        {
+            for (int index = 0; index < band_count; index++)
+                encode_band(index);
+        }
+
+        size_t length = 0;
+        bool any_delta = false;
+        for (const EncoderBand &band : this->bands)
+        {
+            length += band.output.length();
+            any_delta |= !band.repainted;
+        }
+
+        output.reserve(length);
+        for (const EncoderBand &band : this->bands)
+            output += band.output;
+
+        if (any_delta)
+            this->delta_frames++;
+        else
+            this->full_frames++;
+        this->full_repaint = false;
+    }
+
+    /**
+     * @brief Changes the threshold to use the previous colour set, from the next cell encoded
+     *
+     * @param col_threshold Threshold for each colour channel
+     */
+    void FrameEncoder::set_colour_threshold(uchar col_threshold)
+    {
+        this->col_threshold = col_threshold;
+        this->budget_optimiser.set_colour_threshold(col_threshold);
+    }
+
+    /**
+     * @brief Changes the colours used for output, redrawing every cell in the new colours
+     *        with the next frame
+     *
+     * @param colour_depth Colours used for output, 24 (RGB), 256 or 16
+     */
+    void FrameEncoder::set_colour_depth(int colour_depth)
+    {
+        if (colour_depth == this->colour_depth)
+            return;
+
+        this->colour_depth = colour_depth;
+        this->full_repaint = true;
+    }
+
+    /**
+     * @brief Encodes the bands of every following frame in parallel
+     *
+     * @param worker_pool Pool running the bands, nullptr to encode them one after another
+     */
+    void FrameEncoder::set_worker_pool(WorkerPool *worker_pool)
+    {
+        this->worker_pool = worker_pool;
+    }
+
+    /**
+     * @brief Makes the next frame redraw every cell
+     */
+    void FrameEncoder::force_full_repaint()
+    {
+        this->full_repaint = true;
+    }
+
+    uint64_t FrameEncoder::get_full_frames()
+    {
+        return this->full_frames;
+    }
+
+    uint64_t FrameEncoder::get_delta_frames()
+    {
+        return this->delta_frames;
+    }
+
+    bool FrameEncoder::is_budget_used()
+    {
+        return this->use_budget;
+    }
+
+    double FrameEncoder::get_avg_budget_bytes_saved()
+    {
+        return this->budget_optimiser.get_avg_bytes_saved();
+    }
+
+    double FrameEncoder::get_mean_budget_error()
+    {
+        return this->budget_optimiser.get_mean_error();
+    }
+
+    /**
+     * @brief Maps every cell's colour to the closest palette colour for 256 & 16 colour output,
+     *        dithered row by row when enabled
+     *
+     * @param cells Cells of the frame, row by row
+     * @param width Width of the frame in cells
+     * @param height Height of the frame in cells
+     */
+    void FrameEncoder::quantise(std::vector<Cell> &cells, const int width, const int height)
+    {
+        if (!this->print_colour || this->colour_depth == 24)
+            return;
+
+        if (!this->fg_ditherer.is_enabled())
+        {
+            auto palette_index = (this->colour_depth == 256) ? get_xterm256_index : get_ansi16_index;
+            for (Cell &cell : cells)
+            {
+                cell.colour = palette_index(cell.r, cell.g, cell.b);
+                if (this->use_background)
+                    cell.bg_colour = palette_index(cell.bg_r, cell.bg_g, cell.bg_b);
+            }
+            return;
+        }
+
+        uchar *rgb = this->row_rgb.data(),
+              *indices = this->row_palette.data();
+
+        for (int row = 0; row < height; row++)
+        {
+            Cell *row_cells = &cells[row * width];
+
+            for (int col = 0; col < width; col++)
+            {
+                rgb[col * 3] = row_cells[col].b;
+                rgb[col * 3 + 1] = row_cells[col].g;
+                rgb[col * 3 + 2] = row_cells[col].r;
+            }
+            this->fg_ditherer.dither_palette(rgb, width, row, this->colour_depth, indices);
+            for (int col = 0; col < width; col++)
+                row_cells[col].colour = indices[col];
+
+            if (!this->use_background)
+                continue;
+
+            for (int col = 0; col < width; col++)
+            {
+                rgb[col * 3] = row_cells[col].bg_b;
+                rgb[col * 3 + 1] = row_cells[col].bg_g;
+                rgb[col * 3 + 2] = row_cells[col].bg_r;
+            }
+            this->bg_ditherer.dither_palette(rgb, width, row, this->colour_depth, indices);
+            for (int col = 0; col < width; col++)
+                row_cells[col].bg_colour = indices[col];
+        }
+    }
+
+    /**
+     * @brief Encodes a band of rows into the band's output, called from the worker pool
+     *
+     * @param cells Cells of the frame, row by row
+     * @param index Index of the band
+     * @param repaint Flag whether to redraw every cell of the band
+     */
+    void FrameEncoder::encode_band(const std::vector<Cell> &cells, const int index, const bool repaint)
+    {
+        EncoderBand &band = this->bands[index];
+        const int row_start = index * ENCODE_BAND_ROWS,
+                  row_end = std::min(row_start + ENCODE_BAND_ROWS, this->screen_height);
+
+        // sized for the worst case so a band never reallocates its buffer
+        band.output.clear();
+        band.output.reserve(8 + (row_end - row_start) * this->screen_width *
+                                    (CURSOR_ESCAPE_MAX + 2 * COLOUR_ESCAPE_MAX + GLYPH_MAX_BYTES));
+
+        this->reset_pen(band);
+        if (!repaint && this->encode_delta(band, cells, row_start, row_end))
+        {
+            band.repainted = false;
+            return;
+        }
+
+        // too many changes, redrawing the band is cheaper
+        band.output.clear();
+        this->reset_pen(band);
+        this->encode_full(band, cells, row_start, row_end);
+        band.last_full_bytes = band.output.length();
+        band.repainted = true;
+    }
+
+    /**
+     * @brief Forgets the terminal's colours at the start of a band, so the first cell drawn
+     *        sets them regardless of the bands before it
+     */
+    void FrameEncoder::reset_pen(EncoderBand &band)
+    {
+        band.optimiser = Optimiser(this->col_threshold);
+        band.pen = {' ', 0, 0, 0, 0, 0, 0, 0, 0};
+        band.pen_colour = band.pen_bg_colour = -1;
+    }
+
+    /**
+     * @brief Redraws every cell of a band from its top left corner, relying on the terminal
+     *        wrapping lines
+     */
+    void FrameEncoder::encode_full(EncoderBand &band, const std::vector<Cell> &cells, const int row_start, const int row_end)
+    {
+        if (row_start == 0)
+            band.output += "\033[H";
+        else
+            append_cursor(band.output, row_start + 1, 1);
+
+        // after the last column is drawn the cursor only wraps when the next glyph is drawn,
+        // the next band places the cursor itself
+        bool at_row_start = true;
+        for (int row = row_start; row < row_end; row++)
+            at_row_start = this->encode_cells(band, cells, row, 0, this->screen_width, row + 1 < row_end, at_row_start);
+    }
+
+    /**
+     * @brief Redraws only runs of changed cells of a band, moving the cursor to the start
+     *        of each run
+     *
+     * @return bool False as soon as the delta is no smaller than the band's last full repaint
+     */
+    bool FrameEncoder::encode_delta(EncoderBand &band, const std::vector<Cell> &cells, const int row_start, const int row_end)
+    {
+        const int width = this->screen_width;
+
+        for (int row = row_start; row < row_end; row++)
+        {
+            const int cell_start = row * width;
+            const uchar *changed = band.row_changed.data();
+            int col = 0;
+
+            this->find_changed_cells(band, &cells[cell_start], cell_start, width);
+
+            while (col < width)
+            {
+                if (!changed[col])
+                {
+                    col++;
+                    continue;
+                }
+
+                // extend the run over short gaps of unchanged cells
+                int run_end = col + 1;
+                for (int gap = 0, next = run_end; next < width && gap <= DELTA_MERGE_GAP; next++)
+                {
+                    if (changed[next])
+                    {
+                        run_end = next + 1;
+                        gap = 0;
+                    }
+                    else
+                        gap++;
+                }
+
+                append_cursor(band.output, row + 1, col + 1);
+                this->encode_cells(band, cells, row, col, run_end, false, true);
+                col = run_end;
+
+                if (band.output.length() >= band.last_full_bytes)
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief Appends a run of cells from the cursor's position. Runs of blanks sharing a
+     *        background are erased with ECH instead when that's fewer bytes than the blanks,
+     *        the cursor is then moved past them as erasing doesn't move it
+     *
+     * @param band Band of the row, the run is appended to its output
+     * @param cells Cells of the frame, row by row
+     * @param row Row of the cells
+     * @param col_start First column to be appended
+     * @param col_end Column after the last one to be appended
+     * @param wrap Flag whether the cursor must end up at the start of the next row
+     * @param cursor_placed Flag whether the cursor is at col_start, instead of waiting to wrap there
+     * @return bool Whether the cursor was moved to the start of the next row
+     */
+    bool FrameEncoder::encode_cells(EncoderBand &band, const std::vector<Cell> &cells, const int row, const int col_start,
+                                    const int col_end, const bool wrap, bool cursor_placed)
+    {
+        std::string &output = band.output;
+        const int row_start = row * this->screen_width;
+        bool moved_to_next_row = false;
+
+        for (int col = col_start; col < col_end;)
+        {
+            const Cell &cell = cells[row_start + col];
+            int erase_end = col + 1;
+
+            if (this->use_background && cell.glyph == ' ')
+            {
+                while (erase_end < col_end && this->is_same_blank(cells[row_start + erase_end], cell))
+                    erase_end++;
+            }
+
+            const int count = erase_end - col;
+            const bool place_cursor = !cursor_placed && col == col_start;
+            int erase_bytes = 3 + decimal_length(count);
+            if (place_cursor)
+                erase_bytes += 5 + decimal_length(row + 1);
+            if (erase_end < col_end)
+                erase_bytes += 3 + decimal_length(count);
+            else if (wrap && row + 1 < this->screen_height)
+                erase_bytes += 5 + decimal_length(row + 2);
+
+            if (erase_bytes >= count)
+            {
+                this->encode_cell(band, cell, row_start + col);
+                col++;
+                continue;
+            }
+
+            // erasing doesn't wrap a cursor waiting at the end of the previous row
+            if (place_cursor)
+                append_cursor(output, row + 1, col + 1);
+
+            // the erased cells take the background of the pen, set by the run's first cell
+            this->apply_colours(band, cell);
+            output.append("\033[", 2);
+            append_decimal(output, count);
+            output += 'X';
+
+            if (erase_end < col_end)
+            {
+                output.append("\033[", 2);
+                append_decimal(output, count);
+                output += 'C';
+            }
+            else if (wrap && row + 1 < this->screen_height)
+            {
+                append_cursor(output, row + 2, 1);
+                moved_to_next_row = true;
+            }
+
+            for (; col < erase_end; col++)
+                this->record_cell(band, cell, row_start + col);
+        }
+
+        return moved_to_next_row;
+    }
+
+    /**
+     * @brief Appends a cell, with an ANSI colour only when necessary, and records what the
+     *        terminal is now showing in its place
+     *
+     * @param band Band of the cell, the cell is appended to its output
+     * @param cell Cell to be encoded
+     * @param index Index of the cell on screen
+     */
+    void FrameEncoder::encode_cell(EncoderBand &band, const Cell &cell, const int index)
+    {
+        this->apply_colours(band, cell);
+        append_glyph(band.output, cell.glyph);
+        this->record_cell(band, cell, index);
+    }
+
+    /**
+     * @brief Sets the terminal's colours for a cell when they differ from the pen
+     *
+     * @param band Band of the cell, holding the pen & output
+     * @param cell Cell about to be drawn
+     */
+    void FrameEncoder::apply_colours(EncoderBand &band, const Cell &cell)
+    {
+        std::string &output = band.output;
+
+        if (this->print_colour && this->colour_depth != 24)
+        {
+            // palette codes are short enough that the threshold isn't needed
+            if (cell.glyph != ' ' && cell.colour != band.pen_colour)
+            {
+                append_palette_colour(output, cell.colour, this->colour_depth, false);
+                band.pen_colour = cell.colour;
+            }
+            if (this->use_background && cell.bg_colour != band.pen_bg_colour)
+            {
+                append_palette_colour(output, cell.bg_colour, this->colour_depth, true);
+                band.pen_bg_colour = cell.bg_colour;
+            }
+        }
+        else if (this->print_colour)
+        {
+            // the pen is unknown until the first RGB colour, such as after palette output
+            if (cell.glyph != ' ' && (band.pen_colour < 0 || band.optimiser.should_apply_ansi_col(cell.r, cell.g, cell.b, cell.glyph)))
+            {
+                append_rgb_colour(output, cell.r, cell.g, cell.b, false);
+                band.pen_colour = 0;
+
+                // updates previous set of pixel colours
+                band.optimiser.set_prev_colours(cell.r, cell.g, cell.b);
+                band.pen.r = cell.r;
+                band.pen.g = cell.g;
+                band.pen.b = cell.b;
+            }
+
+            // only the background changes when the foreground is within the threshold
+            if (this->use_background &&
+                (band.pen_bg_colour < 0 ||
+                 this->is_colour_changed(cell.bg_r, cell.bg_g, cell.bg_b, band.pen.bg_r, band.pen.bg_g, band.pen.bg_b)))
+            {
+                append_rgb_colour(output, cell.bg_r, cell.bg_g, cell.bg_b, true);
+                band.pen_bg_colour = 0;
+                band.pen.bg_r = cell.bg_r;
+                band.pen.bg_g = cell.bg_g;
+                band.pen.bg_b = cell.bg_b;
+            }
+        }
+    }
+
+    /**
+     * @brief Records what the terminal is showing in place of a cell after it's drawn
+     *
+     * @param band Band of the cell, holding the pen
+     * @param cell Cell that was drawn
+     * @param index Index of the cell on screen
+     */
+    void FrameEncoder::record_cell(EncoderBand &band, const Cell &cell, const int index)
+    {
+        uchar *shown_rgb = &this->screen_rgb[index * 3];
+        shown_rgb[0] = band.pen.b;
+        shown_rgb[1] = band.pen.g;
+        shown_rgb[2] = band.pen.r;
+        this->screen[index] = {cell.glyph,
+                               band.pen.r, band.pen.g, band.pen.b, static_cast<uchar>(band.pen_colour),
+                               band.pen.bg_r, band.pen.bg_g, band.pen.bg_b, static_cast<uchar>(band.pen_bg_colour)};
+    }
+
+    /**
+     * @brief Flags the cells of a row that need to be redrawn, RGB foreground colours are
+     *        compared against the screen a whole row at a time
+     *
+     * @param band Band of the row, the flags are written to its row_changed
+     * @param cells Cells of the row in the new frame
+     * @param row_start Index of the row's first cell on screen
+     * @param width Width of the row in cells
+     */
+    void FrameEncoder::find_changed_cells(EncoderBand &band, const Cell *cells, const int row_start, const int width)
+    {
+        const Cell *shown = &this->screen[row_start];
+        uchar *changed = band.row_changed.data();
+        bool rgb = this->print_colour && this->colour_depth == 24;
+
+        if (rgb)
+        {
+            uchar *frame_rgb = band.row_rgb.data();
+            for (int col = 0; col < width; col++)
+            {
+                frame_rgb[col * 3] = cells[col].b;
+                frame_rgb[col * 3 + 1] = cells[col].g;
+                frame_rgb[col * 3 + 2] = cells[col].r;
+            }
+
+            get_kernels().colour_changed_row(frame_rgb, &this->screen_rgb[row_start * 3], width, this->col_threshold, changed);
+        }
+
+        for (int col = 0; col < width; col++)
+            changed[col] = this->is_changed(cells[col], shown[col], rgb && changed[col]);
+    }
+
+    /**
+     * @brief Checks whether a cell looks different from what's on screen
+     *
+     * @param cell Cell of the new frame
+     * @param shown Cell on screen
+     * @param fg_changed Whether the RGB foreground is outside of the threshold, unused for palettes
+     * @return bool Whether the cell needs to be redrawn
+     */
+    bool FrameEncoder::is_changed(const Cell &cell, const Cell &shown, bool fg_changed)
+    {
+        if (cell.glyph != shown.glyph)
+            return true;
+
+        if (!this->print_colour)
+            return false;
+
+        bool palette = (this->colour_depth != 24);
+
+        // foreground colour of a blank doesn't show
+        if (cell.glyph != ' ' && (palette ? cell.colour != shown.colour : fg_changed))
+            return true;
+
+        if (!this->use_background)
+            return false;
+
+        return palette ? cell.bg_colour != shown.bg_colour
+                       : this->is_colour_changed(cell.bg_r, cell.bg_g, cell.bg_b, shown.bg_r, shown.bg_g, shown.bg_b);
+    }
+
+    /**
+     * @brief Checks whether a cell is a blank that looks the same as another blank
+     *
+     * @param cell Cell to check
+     * @param blank Blank the run started with
+     * @return bool Whether the cell can be erased along with the blank
+     */
+    bool FrameEncoder::is_same_blank(const Cell &cell, const Cell &blank)
+    {
+        if (cell.glyph != ' ')
+            return false;
+
+        return (this->colour_depth != 24) ? cell.bg_colour == blank.bg_colour
+                                          : !this->is_colour_changed(cell.bg_r, cell.bg_g, cell.bg_b, blank.bg_r, blank.bg_g, blank.bg_b);
+    }
+
+    /**
+     * @brief Checks whether 2 RGB colours differ by more than the colour threshold
+     *
+     * @return bool Whether any channel is outside of the threshold
+     */
+    bool FrameEncoder::is_colour_changed(uchar r, uchar g, uchar b, uchar prev_r, uchar prev_g, uchar prev_b)
+    {
+        return abs(r - prev_r) > this->col_threshold ||
+               abs(g - prev_g) > this->col_threshold ||
+               abs(b - prev_b) > this->col_threshold;
+    }
+
+    /**
+     * @brief Appends a unicode code point encoded as UTF-8
+     *
+     * @param output String to append to
+     * @param glyph Unicode code point
+     */
+    void append_glyph(std::string &output, uint32_t glyph)
+    {
+        if (glyph < 0x80)
+        {
+            output += static_cast<char>(glyph);
+        }
+        else if (glyph < 0x800)
+        {
+            output += static_cast<char>(0xC0 | (glyph >> 6));
+            output += static_cast<char>(0x80 | (glyph & 0x3F));
+        }
+        else if (glyph < 0x10000)
+        {
+            output += static_cast<char>(0xE0 | (glyph >> 12));
+            output += static_cast<char>(0x80 | ((glyph >> 6) & 0x3F));
+            output += static_cast<char>(0x80 | (glyph & 0x3F));
+        }
+        else
+        {
+            output += static_cast<char>(0xF0 | (glyph >> 18));
+            output += static_cast<char>(0x80 | ((glyph >> 12) & 0x3F));
+            output += static_cast<char>(0x80 | ((glyph >> 6) & 0x3F));
+            output += static_cast<char>(0x80 | (glyph & 0x3F));
+        }
+    }
+
+    /**
+     * @brief Number of digits of a non-negative integer as decimal text
+     */
+    int decimal_length(int value)
+    {
+        int length = 1;
+        for (; value >= 10; value /= 10)
+            length++;
+        return length;
+    }
+
+    /**
+     * @brief Appends a non-negative integer as decimal text
+     *
+     * @param output String to append to
+     * @param value Value to be appended
+     */
+    void append_decimal(std::string &output, int value)
+    {
+        if (value < 256)
+        {
+            const DecimalText &entry = decimal_table[value];
+            output.append(entry.text, entry.length);
+            return;
+        }
+
+        char digits[10];
+        int length = 0;
+        for (; value > 0; value /= 10)
+            digits[length++] = static_cast<char>('0' + value % 10);
+        while (length > 0)
+            output += digits[--length];
+    }
+
+    /**
+     * @brief Appends an escape moving the cursor to a 1-based row & column
+     *
+     * @param output String to append to
+     * @param row Row of the cursor, starting from 1
+     * @param col Column of the cursor, starting from 1
+     */
+    void append_cursor(std::string &output, int row, int col)
+    {
+        output.append("\033[", 2);
+        append_decimal(output, row);
+        output += ';';
+        append_decimal(output, col);
+        output += 'H';
+    }
+
+    /**
+     * @brief Appends an escape setting an RGB foreground or background colour
+     *
+     * @param output String to append to
+     * @param r Redness value (0-255)
+     * @param g Greenness value (0-255)
+     * @param b Blueness value (0-255)
+     * @param background Flag whether to set the background colour
+     */
+    void append_rgb_colour(std::string &output, uchar r, uchar g, uchar b, bool background)
+    {
+        output.append(background ? "\033[48;2;" : "\033[38;2;", 7);
+        output.append(decimal_table[r].text, decimal_table[r].length);
+        output += ';';
+        output.append(decimal_table[g].text, decimal_table[g].length);
+        output += ';';
+        output.append(decimal_table[b].text, decimal_table[b].length);
+        output += 'm';
+    }
+
+    /**
+     * @brief Appends an escape setting a palette foreground or background colour
+     *
+     * @param output String to append to
+     * @param index Palette index, 0-15 for 16 colours
+     * @param colour_depth Either 256 or 16
+     * @param background Flag whether to set the background colour
+     */
+    void append_palette_colour(std::string &output, uchar index, int colour_depth, bool background)
+    {
+        if (colour_depth == 256)
+        {
+            output.append(background ? "\033[48;5;" : "\033[38;5;", 7);
+            output.append(decimal_table[index].text, decimal_table[index].length);
+        }
+        else
+        {
+            // normal colours are 30-37, bright colours are 90-97, backgrounds are 10 higher
+            int code_index = ((index < 8) ? 30 + index : 82 + index) + (background ? 10 : 0);
+            const DecimalText &code = decimal_table[code_index];
+            output.append("\033[", 2);
+            output.append(code.text, code.length);
+        }
+
+        output += 'm';
+    }
+}
\ No newline at end of file
@@ -0,0 +1,375 @@
+#include "kernels.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define KERNELS_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#elif defined(__aarch64__) || defined(__ARM_NEON)
+#define KERNELS_NEON
+#include <arm_neon.h>
+#endif
+
+// GCC & Clang need the instruction set enabled per function, MSVC allows intrinsics anywhere
+#if defined(KERNELS_X86) && (defined(__GNUC__) || defined(__clang__))
+#define KERNEL_TARGET(isa) __attribute__((target(isa)))
+#else
+#define KERNEL_TARGET(isa)
+#endif
+
+namespace TermVideo
+{
+    static void luminance_row_scalar(const uchar *bgr, uchar *luminance, int count, bool force_avg_luminance)
+    {
+        const int weight_r = force_avg_luminance ? AVG_WEIGHT_R : LUMA_WEIGHT_R,
+                  weight_g = force_avg_luminance ? AVG_WEIGHT_G : LUMA_WEIGHT_G,
+                  weight_b = force_avg_luminance ? AVG_WEIGHT_B : LUMA_WEIGHT_B;
+
+        for (int i = 0; i < count; i++, bgr += 3)
+            luminance[i] = static_cast<uchar>((weight_b * bgr[0] + weight_g * bgr[1] + weight_r * bgr[2] + 128) >> 8);
+    }
+
+    static void colour_changed_row_scalar(const uchar *bgr, const uchar *ref_bgr, int count, uchar threshold, uchar *changed)
+    {
+        for (int i = 0; i < count; i++, bgr += 3, ref_bgr += 3)
+        {
+            changed[i] = abs(bgr[0] - ref_bgr[0]) > threshold ||
+                         abs(bgr[1] - ref_bgr[1]) > threshold ||
+                         abs(bgr[2] - ref_bgr[2]) > threshold;
+        }
+    }
+
+    static void offset_row_scalar(const uchar *values, const uchar *add, const uchar *sub, int count, uchar *out)
+    {
+        for (int i = 0; i < count; i++)
+            out[i] = static_cast<uchar>(std::clamp(values[i] + add[i] - sub[i], 0, 255));
+    }
+
+    static const Kernels scalar_kernels = {"scalar", luminance_row_scalar, colour_changed_row_scalar, offset_row_scalar};
+
+#if defined(KERNELS_X86)
+    /**
+     * @brief Byte shuffles splitting 48 bytes of BGR24 into 16 bytes per channel,
+     *        indexed by channel, source register & output lane
+     */
+    struct BgrShuffles
+    {
+        alignas(16) signed char masks[3][3][16];
+    };
+
+    static constexpr BgrShuffles bgr_shuffles = []
+    {
+        BgrShuffles shuffles{};
+        for (int channel = 0; channel < 3; channel++)
+            for (int reg = 0; reg < 3; reg++)
+                for (int lane = 0; lane < 16; lane++)
+                {
+                    // -128 has the top bit set which zeroes the lane
+                    int src = lane * 3 + channel;
+                    shuffles.masks[channel][reg][lane] = static_cast<signed char>((src / 16 == reg) ? src % 16 : -128);
+                }
+        return shuffles;
+    }();
+
+    KERNEL_TARGET("ssse3")
+    static inline __m128i load_channel_ssse3(__m128i a0, __m128i a1, __m128i a2, int channel)
+    {
+        const __m128i *masks = reinterpret_cast<const __m128i *>(bgr_shuffles.masks[channel]);
+        return _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a0, _mm_load_si128(masks)),
+                                         _mm_shuffle_epi8(a1, _mm_load_si128(masks + 1))),
+                            _mm_shuffle_epi8(a2, _mm_load_si128(masks + 2)));
+    }
+
+    KERNEL_TARGET("ssse3")
+    static inline void load_bgr_ssse3(const uchar *bgr, __m128i &b, __m128i &g, __m128i &r)
+    {
+        __m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bgr)),
+                a1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bgr + 16)),
+                a2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bgr + 32));
+
+        b = load_channel_ssse3(a0, a1, a2, 0);
+        g = load_channel_ssse3(a0, a1, a2, 1);
+        r = load_channel_ssse3(a0, a1, a2, 2);
+    }
+
+    KERNEL_TARGET("ssse3")
+    static void luminance_row_ssse3(const uchar *bgr, uchar *luminance, int count, bool force_avg_luminance)
+    {
+        const __m128i weight_r = _mm_set1_epi16(force_avg_luminance ? AVG_WEIGHT_R : LUMA_WEIGHT_R),
+                      weight_g = _mm_set1_epi16(force_avg_luminance ? AVG_WEIGHT_G : LUMA_WEIGHT_G),
+                      weight_b = _mm_set1_epi16(force_avg_luminance ? AVG_WEIGHT_B : LUMA_WEIGHT_B),
+                      rounding = _mm_set1_epi16(128),
+                      zero = _mm_setzero_si128();
+
+        int i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            __m128i b, g, r;
+            load_bgr_ssse3(bgr + i * 3, b, g, r);
+
+            // weights add up to 256 so the sums fit in 16 bits
+            __m128i lo = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(b, zero), weight_b),
+                                                     _mm_mullo_epi16(_mm_unpacklo_epi8(g, zero), weight_g)),
+                                       _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(r, zero), weight_r), rounding));
+            __m128i hi = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(b, zero), weight_b),
+                                                     _mm_mullo_epi16(_mm_unpackhi_epi8(g, zero), weight_g)),
+                                       _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(r, zero), weight_r), rounding));
+
+            __m128i out = _mm_packus_epi16(_mm_srli_epi16(lo, 8), _mm_srli_epi16(hi, 8));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(luminance + i), out);
+        }
+
+        luminance_row_scalar(bgr + i * 3, luminance + i, count - i, force_avg_luminance);
+    }
+
+    KERNEL_TARGET("ssse3")
+    static void colour_changed_row_ssse3(const uchar *bgr, const uchar *ref_bgr, int count, uchar threshold, uchar *changed)
+    {
+        const __m128i limit = _mm_set1_epi8(static_cast<char>(threshold)),
+                      one = _mm_set1_epi8(1),
+                      zero = _mm_setzero_si128();
+
+        int i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            __m128i b, g, r, ref_b, ref_g, ref_r;
+            load_bgr_ssse3(bgr + i * 3, b, g, r);
+            load_bgr_ssse3(ref_bgr + i * 3, ref_b, ref_g, ref_r);
+
+            // absolute difference of unsigned bytes through saturating subtraction both ways
+            __m128i diff_b = _mm_or_si128(_mm_subs_epu8(b, ref_b), _mm_subs_epu8(ref_b, b)),
+                    diff_g = _mm_or_si128(_mm_subs_epu8(g, ref_g), _mm_subs_epu8(ref_g, g)),
+                    diff_r = _mm_or_si128(_mm_subs_epu8(r, ref_r), _mm_subs_epu8(ref_r, r));
+            __m128i diff = _mm_max_epu8(_mm_max_epu8(diff_b, diff_g), diff_r);
+
+            __m128i within = _mm_cmpeq_epi8(_mm_subs_epu8(diff, limit), zero);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(changed + i), _mm_andnot_si128(within, one));
+        }
+
+        colour_changed_row_scalar(bgr + i * 3, ref_bgr + i * 3, count - i, threshold, changed + i);
+    }
+
+    KERNEL_TARGET("avx2")
+    static void luminance_row_avx2(const uchar *bgr, uchar *luminance, int count, bool force_avg_luminance)
+    {
+        const __m256i weight_r = _mm256_set1_epi16(force_avg_luminance ? AVG_WEIGHT_R : LUMA_WEIGHT_R),
+                      weight_g = _mm256_set1_epi16(force_avg_luminance ? AVG_WEIGHT_G : LUMA_WEIGHT_G),
+                      weight_b = _mm256_set1_epi16(force_avg_luminance ? AVG_WEIGHT_B : LUMA_WEIGHT_B),
+                      rounding = _mm256_set1_epi16(128),
+                      zero = _mm256_setzero_si256();
+
+        int i = 0;
+        for (; i + 32 <= count; i += 32)
+        {
+            // byte shuffles can't cross 128 bit lanes, so each half is split separately
+            __m128i b0, g0, r0, b1, g1, r1;
+            load_bgr_ssse3(bgr + i * 3, b0, g0, r0);
+            load_bgr_ssse3(bgr + i * 3 + 48, b1, g1, r1);
+
+            __m256i b = _mm256_set_m128i(b1, b0),
+                    g = _mm256_set_m128i(g1, g0),
+                    r = _mm256_set_m128i(r1, r0);
+
+            // unpacking & packing both work per 128 bit lane, so pixel order is kept
+            __m256i lo = _mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(b, zero), weight_b),
+                                                           _mm256_mullo_epi16(_mm256_unpacklo_epi8(g, zero), weight_g)),
+                                          _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(r, zero), weight_r), rounding));
+            __m256i hi = _mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(b, zero), weight_b),
+                                                           _mm256_mullo_epi16(_mm256_unpackhi_epi8(g, zero), weight_g)),
+                                          _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(r, zero), weight_r), rounding));
+
+            __m256i out = _mm256_packus_epi16(_mm256_srli_epi16(lo, 8), _mm256_srli_epi16(hi, 8));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(luminance + i), out);
+        }
+
+        luminance_row_ssse3(bgr + i * 3, luminance + i, count - i, force_avg_luminance);
+    }
+
+    KERNEL_TARGET("avx2")
+    static void colour_changed_row_avx2(const uchar *bgr, const uchar *ref_bgr, int count, uchar threshold, uchar *changed)
+    {
+        const __m256i limit = _mm256_set1_epi8(static_cast<char>(threshold)),
+                      one = _mm256_set1_epi8(1),
+                      zero = _mm256_setzero_si256();
+
+        int i = 0;
+        for (; i + 32 <= count; i += 32)
+        {
+            __m128i b0, g0, r0, b1, g1, r1, ref_b0, ref_g0, ref_r0, ref_b1, ref_g1, ref_r1;
+            load_bgr_ssse3(bgr + i * 3, b0, g0, r0);
+            load_bgr_ssse3(bgr + i * 3 + 48, b1, g1, r1);
+            load_bgr_ssse3(ref_bgr + i * 3, ref_b0, ref_g0, ref_r0);
+            load_bgr_ssse3(ref_bgr + i * 3 + 48, ref_b1, ref_g1, ref_r1);
+
+            __m256i b = _mm256_set_m128i(b1, b0), ref_b = _mm256_set_m128i(ref_b1, ref_b0),
+                    g = _mm256_set_m128i(g1, g0), ref_g = _mm256_set_m128i(ref_g1, ref_g0),
+                    r = _mm256_set_m128i(r1, r0), ref_r = _mm256_set_m128i(ref_r1, ref_r0);
+
+            __m256i diff_b = _mm256_or_si256(_mm256_subs_epu8(b, ref_b), _mm256_subs_epu8(ref_b, b)),
+                    diff_g = _mm256_or_si256(_mm256_subs_epu8(g, ref_g), _mm256_subs_epu8(ref_g, g)),
+                    diff_r = _mm256_or_si256(_mm256_subs_epu8(r, ref_r), _mm256_subs_epu8(ref_r, r));
+            __m256i diff = _mm256_max_epu8(_mm256_max_epu8(diff_b, diff_g), diff_r);
+
+            __m256i within = _mm256_cmpeq_epi8(_mm256_subs_epu8(diff, limit), zero);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(changed + i), _mm256_andnot_si256(within, one));
+        }
+
+        colour_changed_row_ssse3(bgr + i * 3, ref_bgr + i * 3, count - i, threshold, changed + i);
+    }
+
+    KERNEL_TARGET("ssse3")
+    static void offset_row_ssse3(const uchar *values, const uchar *add, const uchar *sub, int count, uchar *out)
+    {
+        int i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values + i));
+            v = _mm_adds_epu8(v, _mm_loadu_si128(reinterpret_cast<const __m128i *>(add + i)));
+            v = _mm_subs_epu8(v, _mm_loadu_si128(reinterpret_cast<const __m128i *>(sub + i)));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), v);
+        }
+
+        offset_row_scalar(values + i, add + i, sub + i, count - i, out + i);
+    }
+
+    KERNEL_TARGET("avx2")
+    static void offset_row_avx2(const uchar *values, const uchar *add, const uchar *sub, int count, uchar *out)
+    {
+        int i = 0;
+        for (; i + 32 <= count; i += 32)
+        {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i));
+            v = _mm256_adds_epu8(v, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(add + i)));
+            v = _mm256_subs_epu8(v, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(sub + i)));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), v);
+        }
+
+        offset_row_ssse3(values + i, add + i, sub + i, count - i, out + i);
+    }
+
+    static const Kernels ssse3_kernels = {"ssse3", luminance_row_ssse3, colour_changed_row_ssse3, offset_row_ssse3};
+    static const Kernels avx2_kernels = {"avx2", luminance_row_avx2, colour_changed_row_avx2, offset_row_avx2};
+
+    static bool cpu_supports_ssse3()
+    {
+#if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 1);
+        return info[2] & (1 << 9);
+#else
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("ssse3");
+#endif
+    }
+
+    static bool cpu_supports_avx2()
+    {
+#if defined(_MSC_VER)
+        // the OS also has to save the AVX registers
+        int info[4];
+        __cpuid(info, 1);
+        bool os_avx = (info[2] & (1 << 27)) && (_xgetbv(0) & 6) == 6;
+        __cpuidex(info, 7, 0);
+        return os_avx && (info[1] & (1 << 5));
+#else
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+#elif defined(KERNELS_NEON)
+    static void luminance_row_neon(const uchar *bgr, uchar *luminance, int count, bool force_avg_luminance)
+    {
+        const uint8x8_t weight_r = vdup_n_u8(force_avg_luminance ? AVG_WEIGHT_R : LUMA_WEIGHT_R),
+                        weight_g = vdup_n_u8(force_avg_luminance ? AVG_WEIGHT_G : LUMA_WEIGHT_G),
+                        weight_b = vdup_n_u8(force_avg_luminance ? AVG_WEIGHT_B : LUMA_WEIGHT_B);
+
+        int i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            // loads split the channels on the way in
+            uint8x16x3_t pixels = vld3q_u8(bgr + i * 3);
+
+            uint16x8_t lo = vmull_u8(vget_low_u8(pixels.val[0]), weight_b);
+            lo = vmlal_u8(lo, vget_low_u8(pixels.val[1]), weight_g);
+            lo = vmlal_u8(lo, vget_low_u8(pixels.val[2]), weight_r);
+
+            uint16x8_t hi = vmull_u8(vget_high_u8(pixels.val[0]), weight_b);
+            hi = vmlal_u8(hi, vget_high_u8(pixels.val[1]), weight_g);
+            hi = vmlal_u8(hi, vget_high_u8(pixels.val[2]), weight_r);
+
+            // rounding shift adds 128 before shifting, same as the scalar kernel
+            vst1q_u8(luminance + i, vcombine_u8(vrshrn_n_u16(lo, 8), vrshrn_n_u16(hi, 8)));
+        }
+
+        luminance_row_scalar(bgr + i * 3, luminance + i, count - i, force_avg_luminance);
+    }
+
+    static void colour_changed_row_neon(const uchar *bgr, const uchar *ref_bgr, int count, uchar threshold, uchar *changed)
+    {
+        const uint8x16_t limit = vdupq_n_u8(threshold),
+                         one = vdupq_n_u8(1);
+
+        int i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            uint8x16x3_t pixels = vld3q_u8(bgr + i * 3),
+                         ref_pixels = vld3q_u8(ref_bgr + i * 3);
+
+            uint8x16_t diff = vmaxq_u8(vmaxq_u8(vabdq_u8(pixels.val[0], ref_pixels.val[0]),
+                                                vabdq_u8(pixels.val[1], ref_pixels.val[1])),
+                                       vabdq_u8(pixels.val[2], ref_pixels.val[2]));
+            vst1q_u8(changed + i, vandq_u8(vcgtq_u8(diff, limit), one));
+        }
+
+        colour_changed_row_scalar(bgr + i * 3, ref_bgr + i * 3, count - i, threshold, changed + i);
+    }
+
+    static void offset_row_neon(const uchar *values, const uchar *add, const uchar *sub, int count, uchar *out)
+    {
+        int i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            uint8x16_t v = vqaddq_u8(vld1q_u8(values + i), vld1q_u8(add + i));
+            vst1q_u8(out + i, vqsubq_u8(v, vld1q_u8(sub + i)));
+        }
+
+        offset_row_scalar(values + i, add + i, sub + i, count - i, out + i);
+    }
+
+    static const Kernels neon_kernels = {"neon", luminance_row_neon, colour_changed_row_neon, offset_row_neon};
+#endif
+
+    /**
+     * @brief Returns every kernel implementation the CPU can run, slowest first
+     * @return std::vector<const Kernels *> Supported kernels, always starting with scalar
+     */
+    std::vector<const Kernels *> get_supported_kernels()
+    {
+        std::vector<const Kernels *> kernels = {&scalar_kernels};
+
+#if defined(KERNELS_X86)
+        if (cpu_supports_ssse3())
+            kernels.push_back(&ssse3_kernels);
+        if (cpu_supports_ssse3() && cpu_supports_avx2())
+            kernels.push_back(&avx2_kernels);
+#elif defined(KERNELS_NEON)
+        kernels.push_back(&neon_kernels);
+#endif
+
+        return kernels;
+    }
+
+    /**
+     * @brief Returns the fastest kernels supported by the CPU, picked on first use
+     * @return const Kernels& Kernel implementation
+     */
+    const Kernels &get_kernels()
+    {
+        static const Kernels *kernels = get_supported_kernels().back();
+        return *kernels;
+    }
+}
\ No newline at end of file
@@ -7,6 +7,7 @@
 #include <vector>
 
 #include "audio_player.hpp"
+#include "benchmark.hpp"
 #include "buffer_renderer.hpp"
 #include "export.hpp"
 #include "keyboard.hpp"
@@ -40,6 +41,12 @@ int main(int argc, char **argv)
         return 0;
     }
 
+    if (opts.benchmark)
+    {
+        TermVideo::run_benchmark();
+        return 0;
+    }
+
     TermVideo::MediaPlayer media_player;
     res = media_player.init_player(opts);
     if (res.length() > 0)
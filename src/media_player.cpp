@@ -4,15 +4,19 @@ namespace TermVideo
 {
     MediaPlayer::MediaPlayer()
     {
-        this->info = new MediaInfo();
+        this->info = new VideoInfo();
+        this->demuxer = nullptr;
         this->audio_player = nullptr;
         this->renderer = nullptr;
+        this->tvid_player = nullptr;
     }
 
     MediaPlayer::~MediaPlayer()
     {
+        delete this->tvid_player;
         delete this->renderer;
         delete this->audio_player;
+        delete this->demuxer;
         delete this->info;
     }
 
@@ -25,7 +29,18 @@ namespace TermVideo
     {
         this->seek_step_ms = opts.seek_step_ms;
 
-        if (opts.use_buffer)
+        // pre-rendered frames need neither a demuxer nor a renderer
+        if (opts.playback_path.length() > 0)
+        {
+            this->tvid_player = new TvidPlayer(this->info, opts);
+            return this->tvid_player->init_player();
+        }
+
+        if (opts.export_path.length() > 0)
+            this->renderer = new ExportRenderer(this->info, opts);
+        else if (opts.headless)
+            this->renderer = new HeadlessRenderer(this->info, opts);
+        else if (opts.use_buffer)
             this->renderer = new BufferRenderer(this->info, opts);
         else
             this->renderer = new Renderer(this->info, opts);
@@ -33,7 +48,12 @@ namespace TermVideo
         this->renderer->init_renderer();
 
 #ifdef __USE_FFMPEG
-        std::string res = this->renderer->open_file();
+        this->demuxer = new Demuxer(this->info);
+        std::string res = this->demuxer->open_file(opts.filename);
+        if (res.length() > 0)
+            return res;
+
+        res = this->renderer->get_video_stream();
         if (res.length() > 0)
             return res;
 
@@ -41,8 +61,11 @@ namespace TermVideo
         if (res.length() > 0)
             return res;
 
+        // playback continues without audio if it can't be set up
         this->audio_player = new AudioPlayer(this->info);
         this->audio_player->init_player(opts);
+
+        this->demuxer->init_queues();
 #endif
 
         return "";
@@ -50,10 +73,25 @@ namespace TermVideo
 
     void MediaPlayer::play_file()
     {
-    std::thread video_thread(&Renderer::start_renderer, this->renderer);
+        if (this->tvid_player != nullptr)
+        {
+            this->tvid_player->play();
+            return;
+        }
+
+#ifdef __USE_FFMPEG
+        std::thread demux_thread(&Demuxer::demux, this->demuxer);
+#endif
+        std::thread video_thread(&Renderer::start_renderer, this->renderer);
         std::thread audio_thread(&AudioPlayer::play_file, this->audio_player);
 
         video_thread.join();
+
+#ifdef __USE_FFMPEG
+        // audio stops with the video, also unblocks the demuxer if the renderer quit early
+        this->demuxer->stop();
+        demux_thread.join();
+#endif
         audio_thread.join();
     }
 
@@ -64,7 +102,7 @@ namespace TermVideo
     void MediaPlayer::seek(bool seek_back)
     {
         int64_t rel_time = this->seek_step_ms;
-        int flags = AVSEEK_FLAG_FRAME;
+        int flags = 0;
 
         if (seek_back)
         {
@@ -72,7 +110,8 @@ namespace TermVideo
             flags |= AVSEEK_FLAG_BACKWARD;
         }
 
-        this->info->a_seek = {this->info->a_clock_ms + rel_time, flags, true};
-        this->info->v_seek = {this->info->v_clock_ms + rel_time, flags, true};
+        // audio clock is the master clock whenever audio is playing
+        double clock_ms = (this->info->a_clock_ms > 0) ? this->info->a_clock_ms : this->info->v_clock_ms;
+        this->info->seek = {clock_ms + rel_time, flags, true};
     }
 }
\ No newline at end of file
@@ -38,10 +38,10 @@ void TermVideo::Optimiser::set_colour_threshold(uchar col_threshold)
  * @param r Redness value (0-255)
  * @param g Greenness value (0-255)
  * @param b Blueness value (0-255)
- * @param c Character to be printed
+ * @param glyph Unicode code point of the character to be printed
  * @return bool Whether to use ANSI colour coding
  */
-bool TermVideo::Optimiser::should_apply_ansi_col(uchar r, uchar g, uchar b, std::string c)
+bool TermVideo::Optimiser::should_apply_ansi_col(uchar r, uchar g, uchar b, uint32_t glyph)
 {
     uchar diff_r = abs(this->prev_r - r);
     uchar diff_g = abs(this->prev_g - g);
@@ -49,6 +49,222 @@ bool TermVideo::Optimiser::should_apply_ansi_col(uchar r, uchar g, uchar b, std:
 
     // apply ansi colour if pixel is outside of threshold range of previous pixel
     // and character is not a blank
-    bool apply_ansi = (diff_r > this->col_threshold && diff_g > this->col_threshold && diff_b > this->col_threshold) && (c != " ");
+    bool apply_ansi = (diff_r > this->col_threshold || diff_g > this->col_threshold || diff_b > this->col_threshold) && (glyph != ' ');
     return apply_ansi;
+}
+
+TermVideo::BudgetOptimiser::BudgetOptimiser() : BudgetOptimiser(0, 0) {}
+
+/**
+ * @brief Construct a new BudgetOptimiser object
+ *
+ * @param col_threshold Threshold to use the previous colour set, used to estimate the bytes saved
+ * @param max_error Largest perceptual distance of a cell from the colour of its run
+ */
+TermVideo::BudgetOptimiser::BudgetOptimiser(uchar col_threshold, int max_error)
+{
+    this->col_threshold = col_threshold;
+    this->max_error = max_error;
+    this->frames = this->error_cells = 0;
+    this->bytes_saved = 0;
+    this->error_total = 0;
+}
+
+/**
+ * @brief Sets the colour threshold the bytes saved are estimated with
+ *
+ * @param col_threshold Threshold value for each colour to check
+ */
+void TermVideo::BudgetOptimiser::set_colour_threshold(uchar col_threshold)
+{
+    this->col_threshold = col_threshold;
+}
+
+/**
+ * @brief Recolours every row of a frame in place
+ *
+ * @param cells Cells of the frame, row by row
+ * @param width Width of the frame in cells
+ * @param height Height of the frame in cells
+ */
+void TermVideo::BudgetOptimiser::optimise(std::vector<Cell> &cells, int width, int height)
+{
+    this->row_cost.resize(width + 1);
+    this->run_start.resize(width + 1);
+
+    for (int row = 0; row < height; row++)
+    {
+        Cell *row_cells = &cells[row * width];
+        int original_bytes = this->count_escape_bytes(row_cells, width);
+        this->optimise_row(row_cells, width);
+        this->bytes_saved += original_bytes - this->count_escape_bytes(row_cells, width);
+    }
+
+    this->frames++;
+}
+
+/**
+ * @brief Finds the runs of a row needing the fewest escape bytes, cheapest cost up to
+ *        each column is the cheapest cost up to a run's start plus the run's escape
+ *
+ * @param cells Cells of the row
+ * @param width Width of the row in cells
+ */
+void TermVideo::BudgetOptimiser::optimise_row(Cell *cells, int width)
+{
+    std::vector<int> &cost = this->row_cost;
+    std::fill(cost.begin(), cost.end(), INT_MAX);
+    cost[0] = 0;
+
+    for (int start = 0; start < width; start++)
+    {
+        int min_r = 255, min_g = 255, min_b = 255, max_r = 0, max_g = 0, max_b = 0;
+        int sum_r = 0, sum_g = 0, sum_b = 0, count = 0;
+
+        for (int end = start; end < width && end - start < BUDGET_MAX_RUN; end++)
+        {
+            const Cell &cell = cells[end];
+
+            // colour of a blank doesn't show, it fits in any run
+            if (cell.glyph != ' ')
+            {
+                min_r = std::min<int>(min_r, cell.r), max_r = std::max<int>(max_r, cell.r);
+                min_g = std::min<int>(min_g, cell.g), max_g = std::max<int>(max_g, cell.g);
+                min_b = std::min<int>(min_b, cell.b), max_b = std::max<int>(max_b, cell.b);
+                sum_r += cell.r, sum_g += cell.g, sum_b += cell.b;
+                count++;
+
+                // the spread only grows, so neither will any longer run fit
+                if (!this->is_within_bound(max_r - min_r, max_g - min_g, max_b - min_b))
+                    break;
+            }
+
+            int bytes = cost[start];
+            if (count > 0)
+                bytes += get_rgb_escape_length((sum_r + count / 2) / count, (sum_g + count / 2) / count, (sum_b + count / 2) / count);
+
+            if (bytes < cost[end + 1])
+            {
+                cost[end + 1] = bytes;
+                this->run_start[end + 1] = start;
+            }
+        }
+    }
+
+    // walk back from the end of the row, giving each run its average colour
+    for (int end = width; end > 0;)
+    {
+        int start = this->run_start[end];
+        int sum_r = 0, sum_g = 0, sum_b = 0, count = 0;
+
+        for (int col = start; col < end; col++)
+        {
+            if (cells[col].glyph == ' ')
+                continue;
+
+            sum_r += cells[col].r, sum_g += cells[col].g, sum_b += cells[col].b;
+            count++;
+        }
+
+        if (count > 0)
+        {
+            uchar r = (sum_r + count / 2) / count,
+                  g = (sum_g + count / 2) / count,
+                  b = (sum_b + count / 2) / count;
+
+            for (int col = start; col < end; col++)
+            {
+                Cell &cell = cells[col];
+                if (cell.glyph == ' ')
+                    continue;
+
+                int diff_r = cell.r - r, diff_g = cell.g - g, diff_b = cell.b - b;
+                this->error_total += sqrt(static_cast<double>(BUDGET_WEIGHT_R * diff_r * diff_r +
+                                                              BUDGET_WEIGHT_G * diff_g * diff_g +
+                                                              BUDGET_WEIGHT_B * diff_b * diff_b) /
+                                          BUDGET_WEIGHT_SUM);
+                this->error_cells++;
+
+                cell.r = r;
+                cell.g = g;
+                cell.b = b;
+            }
+        }
+
+        end = start;
+    }
+}
+
+/**
+ * @brief Checks whether every colour of a run is close enough to the run's average. The
+ *        channel ranges bound how far any colour can be from the average
+ *
+ * @param range_r Difference between the largest & smallest red in the run
+ * @param range_g Difference between the largest & smallest green in the run
+ * @param range_b Difference between the largest & smallest blue in the run
+ * @return bool Whether the run is within the error bound
+ */
+bool TermVideo::BudgetOptimiser::is_within_bound(int range_r, int range_g, int range_b)
+{
+    int distance = BUDGET_WEIGHT_R * range_r * range_r +
+                   BUDGET_WEIGHT_G * range_g * range_g +
+                   BUDGET_WEIGHT_B * range_b * range_b;
+    return distance <= this->max_error * this->max_error * BUDGET_WEIGHT_SUM;
+}
+
+/**
+ * @brief Counts the colour escape bytes a row is printed with, the same way the
+ *        encoder skips colours within the colour threshold of the previous one
+ *
+ * @param cells Cells of the row
+ * @param width Width of the row in cells
+ * @return int Bytes of colour escapes
+ */
+int TermVideo::BudgetOptimiser::count_escape_bytes(const Cell *cells, int width)
+{
+    Optimiser optimiser(this->col_threshold);
+    int bytes = 0;
+    bool has_colour = false;
+
+    for (int col = 0; col < width; col++)
+    {
+        const Cell &cell = cells[col];
+        if (cell.glyph == ' ' || (has_colour && !optimiser.should_apply_ansi_col(cell.r, cell.g, cell.b, cell.glyph)))
+            continue;
+
+        bytes += get_rgb_escape_length(cell.r, cell.g, cell.b);
+        optimiser.set_prev_colours(cell.r, cell.g, cell.b);
+        has_colour = true;
+    }
+
+    return bytes;
+}
+
+/**
+ * @brief Average escape bytes removed per frame, compared to printing the original colours
+ */
+double TermVideo::BudgetOptimiser::get_avg_bytes_saved()
+{
+    return (this->frames > 0) ? static_cast<double>(this->bytes_saved) / this->frames : 0;
+}
+
+/**
+ * @brief Average perceptual distance of a recoloured cell from its original colour
+ */
+double TermVideo::BudgetOptimiser::get_mean_error()
+{
+    return (this->error_cells > 0) ? this->error_total / this->error_cells : 0;
+}
+
+/**
+ * @brief Length of the escape setting an RGB foreground colour, "\033[38;2;r;g;bm"
+ *
+ * @return int Length in bytes
+ */
+int TermVideo::get_rgb_escape_length(uchar r, uchar g, uchar b)
+{
+    auto digits = [](uchar value)
+    { return (value >= 100) ? 3 : (value >= 10) ? 2 : 1; };
+
+    return 10 + digits(r) + digits(g) + digits(b);
 }
\ No newline at end of file
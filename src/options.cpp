@@ -1,20 +1,45 @@
 #include "options.hpp"
+#include "dither.hpp"
+#include "scaler.hpp"
 
 TermVideo::Options::Options()
     : filename(),
       char_set(),
       audio_language(),
+      decode_thread_type(),
+      scaler("bilinear"),
+      dither("none"),
+      export_path(),
+      playback_path(),
+      record_path(),
+      render_mode(RenderMode::Block),
       col_threshold(0),
       frames_to_skip(0),
+      frame_queue_size(4),
+      decode_threads(0),
+      encode_threads(0),
+      colour_depth(24),
+      colour_budget(0),
+      max_threshold(48),
+      min_colour_depth(16),
+      min_scale(50),
+      max_skip(2),
       seek_step_ms(5000),
+      grid_width(0),
+      grid_height(0),
       print_colour(false),
       force_aspect(false),
       use_buffer(false),
+      use_curses(false),
       force_avg_lumi(false),
       use_audio(true),
       display_frametime(false),
-      use_ascii(false),
-      disable_frame_sync(false)
+      disable_frame_sync(false),
+      use_delta(true),
+      benchmark(false),
+      adaptive_quality(false),
+      compress_export(false),
+      headless(false)
 {
 }
 
@@ -37,6 +62,59 @@ int TermVideo::parse_arguments(TermVideo::Options &opts, int argc, char **argv)
                 return return_arg_missing_value(arg);
         }
 
+        else if (arg == "-ex" || arg == "--export")
+        {
+            if (i + 1 < argc)
+                opts.export_path = std::string(argv[++i]);
+            else
+                return return_arg_missing_value(arg);
+        }
+
+        else if (arg == "-cx" || arg == "--compress")
+        {
+            opts.compress_export = true;
+        }
+
+        else if (arg == "-rc" || arg == "--record")
+        {
+            if (i + 1 < argc)
+                opts.record_path = std::string(argv[++i]);
+            else
+                return return_arg_missing_value(arg);
+        }
+
+        else if (arg == "-hl" || arg == "--headless")
+        {
+            opts.headless = true;
+        }
+
+        else if (arg == "-pl" || arg == "--play")
+        {
+            if (i + 1 < argc)
+                opts.playback_path = std::string(argv[++i]);
+            else
+                return return_arg_missing_value(arg);
+        }
+
+        else if (arg == "-gs" || arg == "--grid-size")
+        {
+            if (i + 1 >= argc)
+                return return_arg_missing_value(arg);
+
+            std::string value = argv[++i];
+            size_t separator = value.find('x');
+            if (separator != std::string::npos)
+            {
+                opts.grid_width = std::atoi(value.substr(0, separator).c_str());
+                opts.grid_height = std::atoi(value.substr(separator + 1).c_str());
+            }
+            if (separator == std::string::npos || opts.grid_width <= 0 || opts.grid_height <= 0)
+            {
+                std::cerr << arg << " requires a size in cells such as 120x40" << std::endl;
+                return -1;
+            }
+        }
+
         else if (arg == "-na" || arg == "--no-audio")
         {
             if (opts.audio_language.length() > 0)
@@ -69,6 +147,84 @@ int TermVideo::parse_arguments(TermVideo::Options &opts, int argc, char **argv)
                 return return_arg_missing_value(arg);
         }
 
+        else if (arg == "-cd" || arg == "--color-depth" || arg == "--colour-depth")
+        {
+            if (i + 1 >= argc)
+                return return_arg_missing_value(arg);
+
+            opts.colour_depth = std::stoi(argv[++i]);
+            if (opts.colour_depth != 24 && opts.colour_depth != 256 && opts.colour_depth != 16)
+            {
+                std::cerr << arg << " must be 24, 256 or 16" << std::endl;
+                return -1;
+            }
+        }
+
+        else if (arg == "-cb" || arg == "--color-budget" || arg == "--colour-budget")
+        {
+            if (i + 1 >= argc)
+                return return_arg_missing_value(arg);
+
+            opts.colour_budget = std::stoi(argv[++i]);
+            if (opts.colour_budget < 0 || opts.colour_budget > 255)
+            {
+                std::cerr << arg << " must be between 0 and 255" << std::endl;
+                return -1;
+            }
+        }
+
+        else if (arg == "-mt" || arg == "--max-threshold")
+        {
+            if (i + 1 >= argc)
+                return return_arg_missing_value(arg);
+
+            opts.max_threshold = std::stoi(argv[++i]);
+            if (opts.max_threshold < 0 || opts.max_threshold > 255)
+            {
+                std::cerr << arg << " must be between 0 and 255" << std::endl;
+                return -1;
+            }
+        }
+
+        else if (arg == "-md" || arg == "--min-color-depth" || arg == "--min-colour-depth")
+        {
+            if (i + 1 >= argc)
+                return return_arg_missing_value(arg);
+
+            opts.min_colour_depth = std::stoi(argv[++i]);
+            if (opts.min_colour_depth != 24 && opts.min_colour_depth != 256 && opts.min_colour_depth != 16)
+            {
+                std::cerr << arg << " must be 24, 256 or 16" << std::endl;
+                return -1;
+            }
+        }
+
+        else if (arg == "-ms" || arg == "--min-scale")
+        {
+            if (i + 1 >= argc)
+                return return_arg_missing_value(arg);
+
+            opts.min_scale = std::stoi(argv[++i]);
+            if (opts.min_scale < 10 || opts.min_scale > 100)
+            {
+                std::cerr << arg << " must be a percentage between 10 and 100" << std::endl;
+                return -1;
+            }
+        }
+
+        else if (arg == "-mk" || arg == "--max-skip")
+        {
+            if (i + 1 >= argc)
+                return return_arg_missing_value(arg);
+
+            opts.max_skip = std::stoi(argv[++i]);
+            if (opts.max_skip < 0)
+            {
+                std::cerr << arg << " requires a positive integer" << std::endl;
+                return -1;
+            }
+        }
+
         else if (arg == "-s" || arg == "--skip-frames")
         {
             if (i + 1 < argc)
@@ -77,6 +233,90 @@ int TermVideo::parse_arguments(TermVideo::Options &opts, int argc, char **argv)
                 return return_arg_missing_value(arg);
         }
 
+        else if (arg == "-q" || arg == "--queue-size")
+        {
+            if (i + 1 < argc)
+            {
+                opts.frame_queue_size = std::stoi(argv[++i]);
+                if (opts.frame_queue_size < 1)
+                {
+                    std::cerr << arg << " requires a positive integer" << std::endl;
+                    return -1;
+                }
+            }
+            else
+                return return_arg_missing_value(arg);
+        }
+
+        else if (arg == "-dt" || arg == "--decode-threads")
+        {
+            if (i + 1 >= argc)
+                return return_arg_missing_value(arg);
+
+            // 0 lets FFmpeg pick a thread count based on the number of cores
+            std::string value = argv[++i];
+            opts.decode_threads = (value == "auto") ? 0 : std::stoi(value);
+            if (opts.decode_threads < 0)
+            {
+                std::cerr << arg << " requires a positive integer or \"auto\"" << std::endl;
+                return -1;
+            }
+        }
+
+        else if (arg == "-et" || arg == "--encode-threads")
+        {
+            if (i + 1 >= argc)
+                return return_arg_missing_value(arg);
+
+            // 0 uses a thread per core
+            std::string value = argv[++i];
+            opts.encode_threads = (value == "auto") ? 0 : std::stoi(value);
+            if (opts.encode_threads < 0)
+            {
+                std::cerr << arg << " requires a positive integer or \"auto\"" << std::endl;
+                return -1;
+            }
+        }
+
+        else if (arg == "-tt" || arg == "--thread-type")
+        {
+            if (i + 1 >= argc)
+                return return_arg_missing_value(arg);
+
+            opts.decode_thread_type = argv[++i];
+            if (opts.decode_thread_type != "frame" && opts.decode_thread_type != "slice")
+            {
+                std::cerr << arg << " must be either \"frame\" or \"slice\"" << std::endl;
+                return -1;
+            }
+        }
+
+        else if (arg == "-sc" || arg == "--scaler")
+        {
+            if (i + 1 >= argc)
+                return return_arg_missing_value(arg);
+
+            opts.scaler = argv[++i];
+            if (!Scaler::is_valid_algorithm(opts.scaler))
+            {
+                std::cerr << arg << " must be one of \"fast\", \"area\", \"bilinear\", \"bicubic\" or \"box\"" << std::endl;
+                return -1;
+            }
+        }
+
+        else if (arg == "-di" || arg == "--dither")
+        {
+            if (i + 1 >= argc)
+                return return_arg_missing_value(arg);
+
+            opts.dither = argv[++i];
+            if (!Ditherer::is_valid_mode(opts.dither))
+            {
+                std::cerr << arg << " must be one of \"none\", \"bayer\" or \"fs\"" << std::endl;
+                return -1;
+            }
+        }
+
         else if (arg == "-sk" || arg == "--seek-step")
         {
             if (i + 1 < argc)
@@ -107,6 +347,12 @@ int TermVideo::parse_arguments(TermVideo::Options &opts, int argc, char **argv)
             opts.use_buffer = true;
         }
 
+        else if (arg == "-cu" || arg == "--curses")
+        {
+            opts.use_buffer = true;
+            opts.use_curses = true;
+        }
+
         else if (arg == "-alumi" || arg == "--avg-lumi")
         {
             opts.force_avg_lumi = true;
@@ -119,16 +365,99 @@ int TermVideo::parse_arguments(TermVideo::Options &opts, int argc, char **argv)
 
         else if (arg == "-as" || arg == "--ascii")
         {
-            opts.use_ascii = true;
+            opts.render_mode = RenderMode::Ascii;
+        }
+
+        else if (arg == "-br" || arg == "--braille")
+        {
+            opts.render_mode = RenderMode::Braille;
+        }
+
+        else if (arg == "-qd" || arg == "--quadrants")
+        {
+            opts.render_mode = RenderMode::Quadrant;
+        }
+
+        else if (arg == "-sx" || arg == "--sextants")
+        {
+            opts.render_mode = RenderMode::Sextant;
+        }
+
+        else if (arg == "-sp" || arg == "--spaces")
+        {
+            // pixels are only visible as background colours
+            opts.render_mode = RenderMode::Space;
+            opts.print_colour = true;
+        }
+
+        else if (arg == "-hb" || arg == "--half-blocks")
+        {
+            // both halves of a cell are drawn with colours
+            opts.render_mode = RenderMode::HalfBlock;
+            opts.print_colour = true;
         }
 
         else if (arg == "-nfs" || arg == "--no-frame-sync")
         {
             opts.disable_frame_sync = true;
         }
+
+        else if (arg == "-bm" || arg == "--benchmark")
+        {
+            opts.benchmark = true;
+        }
+
+        else if (arg == "-aq" || arg == "--adaptive-quality")
+        {
+            opts.adaptive_quality = true;
+        }
+
+        else if (arg == "-nd" || arg == "--no-delta")
+        {
+            opts.use_delta = false;
+        }
+    }
+
+    // without ncurses, the buffer on Linux is normal printing with delta output always on
+#if defined(_WIN32)
+    const bool console_buffer = opts.use_buffer;
+#else
+    const bool console_buffer = opts.use_buffer && opts.use_curses;
+#endif
+
+    if (console_buffer && opts.render_mode != RenderMode::Block && opts.render_mode != RenderMode::Ascii)
+    {
+        std::cerr << "Only ASCII characters can be used when writing to the console buffer" << std::endl;
+        return -1;
+    }
+
+    if (opts.use_buffer && !console_buffer)
+        opts.use_delta = true;
+
+    // recordings are made from the text of each frame, which the console buffer doesn't produce
+    if (opts.record_path.length() > 0 && (opts.use_buffer || opts.export_path.length() > 0 || opts.playback_path.length() > 0))
+    {
+        std::cerr << "Recording can't be used with --buffer, --export or --play" << std::endl;
+        return -1;
+    }
+
+    if (opts.headless && opts.record_path.length() == 0)
+    {
+        std::cerr << "Headless mode needs --record to write frames to" << std::endl;
+        return -1;
+    }
+
+    // exports are rendered as fast as possible without the terminal's involvement
+    if (opts.export_path.length() > 0 || opts.headless)
+    {
+        opts.use_audio = false;
+        opts.disable_frame_sync = true;
+        opts.display_frametime = false;
+        opts.adaptive_quality = false;
+        opts.use_buffer = false;
     }
 
-    if (opts.filename.length() == 0)
+    if (opts.filename.length() == 0 && opts.playback_path.length() == 0 && !opts.benchmark)
     {
         std::cerr << "No file provided!" << std::endl;
         return -1;
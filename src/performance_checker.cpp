@@ -5,6 +5,14 @@ TermVideo::PerformanceChecker::PerformanceChecker()
     this->frame_count = 0;
     this->last_frame_time_milli = 0;
     this->frame_time_milli_total = 0;
+    this->dropped_frames = 0;
+    this->late_frames = 0;
+    this->discarded_frames = 0;
+    this->output_frames = 0;
+    this->output_bytes = 0;
+    this->write_count = 0;
+    this->write_time_milli_total = 0;
+    this->write_time_milli_max = 0;
 }
 
 void TermVideo::PerformanceChecker::start_frame_time()
@@ -36,4 +44,83 @@ double TermVideo::PerformanceChecker::get_avg_frame_time_milli()
 int64 TermVideo::PerformanceChecker::get_avg_wait_time()
 {
     return this->wait_time_total / this->frame_count;
+}
+
+/**
+ * @brief Counts a decoded frame that was thrown away instead of being presented
+ */
+void TermVideo::PerformanceChecker::add_dropped_frame()
+{
+    this->dropped_frames++;
+}
+
+/**
+ * @brief Counts a frame presented after its deadline
+ */
+void TermVideo::PerformanceChecker::add_late_frame()
+{
+    this->late_frames++;
+}
+
+/**
+ * @brief Counts frames the decoder skipped without decoding them
+ *
+ * @param count Number of frames skipped
+ */
+void TermVideo::PerformanceChecker::add_discarded_frames(int64 count)
+{
+    this->discarded_frames += count;
+}
+
+/**
+ * @brief Counts the bytes written to the terminal for a frame
+ *
+ * @param bytes Length of the frame's output
+ */
+void TermVideo::PerformanceChecker::add_frame_bytes(int64 bytes)
+{
+    this->output_frames++;
+    this->output_bytes += bytes;
+}
+
+/**
+ * @brief Records how long writing a frame to the terminal took
+ *
+ * @param write_time_milli Time spent in the write, in milliseconds
+ */
+void TermVideo::PerformanceChecker::add_write_time(double write_time_milli)
+{
+    this->write_count++;
+    this->write_time_milli_total += write_time_milli;
+    this->write_time_milli_max = std::max(this->write_time_milli_max, write_time_milli);
+}
+
+int64 TermVideo::PerformanceChecker::get_dropped_frames()
+{
+    return this->dropped_frames;
+}
+
+int64 TermVideo::PerformanceChecker::get_late_frames()
+{
+    return this->late_frames;
+}
+
+int64 TermVideo::PerformanceChecker::get_discarded_frames()
+{
+    return this->discarded_frames;
+}
+
+int64 TermVideo::PerformanceChecker::get_avg_frame_bytes()
+{
+    return (this->output_frames > 0) ? this->output_bytes / this->output_frames : 0;
+}
+
+double TermVideo::PerformanceChecker::get_avg_write_time_milli()
+{
+    return (this->write_count > 0) ? this->write_time_milli_total / this->write_count : 0;
+}
+
+double TermVideo::PerformanceChecker::get_max_write_time_milli()
+{
+    return this->write_time_milli_max;
 }
\ No newline at end of file
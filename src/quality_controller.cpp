@@ -0,0 +1,206 @@
+#include "quality_controller.hpp"
+
+TermVideo::QualityController::QualityController() : QualityController({0, 24, 100, 0}, {0, 24, 100, 0}, false) {}
+
+/**
+ * @brief Construct a new QualityController object
+ *
+ * @param initial Settings from launch, never raised above
+ * @param limits Largest colour threshold & frames to skip, smallest colour depth & output scale
+ * @param enabled Flag whether to adjust anything
+ */
+TermVideo::QualityController::QualityController(QualitySettings initial, QualitySettings limits, bool enabled)
+{
+    this->enabled = enabled;
+    this->initial = initial;
+    this->settings = initial;
+
+    // limits can't be better than the launch settings
+    this->limits = {std::max(limits.col_threshold, initial.col_threshold),
+                    std::min(limits.colour_depth, initial.colour_depth),
+                    std::min(limits.scale_percent, initial.scale_percent),
+                    std::max(limits.frames_to_skip, initial.frames_to_skip)};
+
+    this->window_frames = this->window_late = this->quiet_windows = 0;
+    this->window_busy_milli = this->window_write_milli = 0;
+    this->window_bytes = 0;
+}
+
+/**
+ * @brief Measures a presented frame, adjusting the settings at the end of each window
+ *
+ * @param bytes Bytes written to the terminal for the frame
+ * @param write_milli Time spent writing the frame
+ * @param busy_milli Time spent converting & writing the frame
+ * @param late_milli How far past its deadline the frame was presented, negative when early
+ * @param frametime_milli Time between frames at the current frame decimation
+ * @param clock_milli Position in the video, for the log
+ * @return bool Whether the settings were changed
+ */
+bool TermVideo::QualityController::add_frame(size_t bytes, double write_milli, double busy_milli,
+                                             double late_milli, double frametime_milli, double clock_milli)
+{
+    if (!this->enabled)
+        return false;
+
+    this->window_frames++;
+    this->window_bytes += bytes;
+    this->window_write_milli += write_milli;
+    // the write is normally part of the busy time, but it's the cost of the frame on its own
+    // when it happens outside of it
+    this->window_busy_milli += std::max(busy_milli, write_milli);
+    if (late_milli > 0)
+        this->window_late++;
+
+    if (this->window_frames < QUALITY_WINDOW_FRAMES)
+        return false;
+
+    const double busy_percent = 100 * this->window_busy_milli / (this->window_frames * frametime_milli);
+    const double write_percent = 100 * this->window_write_milli / (this->window_frames * frametime_milli);
+    const bool overloaded = this->window_late * QUALITY_LATE_DIVISOR > this->window_frames ||
+                            busy_percent > QUALITY_BUSY_HIGH_PERCENT || write_percent > QUALITY_WRITE_HIGH_PERCENT;
+    const bool underloaded = this->window_late == 0 && busy_percent < QUALITY_BUSY_LOW_PERCENT;
+
+    std::string change;
+    bool changed = false;
+
+    if (overloaded)
+    {
+        this->quiet_windows = 0;
+        changed = this->lower_quality(change);
+    }
+    else if (underloaded && ++this->quiet_windows >= QUALITY_RECOVER_WINDOWS)
+    {
+        this->quiet_windows = 0;
+        changed = this->raise_quality(change);
+    }
+    else if (!underloaded)
+        this->quiet_windows = 0;
+
+    if (changed)
+        this->add_log(clock_milli, change, busy_percent, frametime_milli);
+
+    this->window_frames = this->window_late = 0;
+    this->window_busy_milli = this->window_write_milli = 0;
+    this->window_bytes = 0;
+    return changed;
+}
+
+const TermVideo::QualitySettings &TermVideo::QualityController::get_settings()
+{
+    return this->settings;
+}
+
+/**
+ * @brief Every adjustment made so far, one line each
+ */
+const std::vector<std::string> &TermVideo::QualityController::get_log()
+{
+    return this->log;
+}
+
+/**
+ * @brief Lowers the setting that costs the least visible quality first
+ *
+ * @param change Description of the adjustment
+ * @return bool False if every setting is at its limit
+ */
+bool TermVideo::QualityController::lower_quality(std::string &change)
+{
+    QualitySettings &s = this->settings;
+
+    if (s.col_threshold < this->limits.col_threshold)
+    {
+        int threshold = std::min<int>(this->limits.col_threshold, std::max(s.col_threshold * 2, s.col_threshold + QUALITY_THRESHOLD_STEP));
+        change = "colour threshold " + std::to_string(s.col_threshold) + " -> " + std::to_string(threshold);
+        s.col_threshold = static_cast<uchar>(threshold);
+        return true;
+    }
+
+    if (s.colour_depth > this->limits.colour_depth)
+    {
+        int depth = (s.colour_depth == 24) ? 256 : 16;
+        change = "colour depth " + std::to_string(s.colour_depth) + " -> " + std::to_string(depth);
+        s.colour_depth = depth;
+        return true;
+    }
+
+    if (s.scale_percent > this->limits.scale_percent)
+    {
+        int scale = std::max(this->limits.scale_percent, s.scale_percent - QUALITY_SCALE_STEP);
+        change = "output scale " + std::to_string(s.scale_percent) + "% -> " + std::to_string(scale) + "%";
+        s.scale_percent = scale;
+        return true;
+    }
+
+    if (s.frames_to_skip < this->limits.frames_to_skip)
+    {
+        change = "frames skipped " + std::to_string(s.frames_to_skip) + " -> " + std::to_string(s.frames_to_skip + 1);
+        s.frames_to_skip++;
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Raises settings back in the reverse order they were lowered
+ *
+ * @param change Description of the adjustment
+ * @return bool False if every setting is back at its launch value
+ */
+bool TermVideo::QualityController::raise_quality(std::string &change)
+{
+    QualitySettings &s = this->settings;
+
+    if (s.frames_to_skip > this->initial.frames_to_skip)
+    {
+        change = "frames skipped " + std::to_string(s.frames_to_skip) + " -> " + std::to_string(s.frames_to_skip - 1);
+        s.frames_to_skip--;
+        return true;
+    }
+
+    if (s.scale_percent < this->initial.scale_percent)
+    {
+        int scale = std::min(this->initial.scale_percent, s.scale_percent + QUALITY_SCALE_STEP);
+        change = "output scale " + std::to_string(s.scale_percent) + "% -> " + std::to_string(scale) + "%";
+        s.scale_percent = scale;
+        return true;
+    }
+
+    if (s.colour_depth < this->initial.colour_depth)
+    {
+        int depth = (s.colour_depth == 16) ? 256 : 24;
+        change = "colour depth " + std::to_string(s.colour_depth) + " -> " + std::to_string(depth);
+        s.colour_depth = depth;
+        return true;
+    }
+
+    if (s.col_threshold > this->initial.col_threshold)
+    {
+        int threshold = std::max<int>(this->initial.col_threshold, s.col_threshold / 2);
+        change = "colour threshold " + std::to_string(s.col_threshold) + " -> " + std::to_string(threshold);
+        s.col_threshold = static_cast<uchar>(threshold);
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Records an adjustment along with the measurements of the window behind it
+ *
+ * @param clock_milli Position in the video
+ * @param change Description of the adjustment
+ * @param busy_percent Average time converting & writing a frame, as a percentage of the frame time
+ * @param frametime_milli Time between frames
+ */
+void TermVideo::QualityController::add_log(double clock_milli, const std::string &change, double busy_percent, double frametime_milli)
+{
+    char line[256];
+    snprintf(line, sizeof(line), "%02d:%06.3f %s (%d/%d frames late, busy %.0f%% of %.1fms, %zu bytes & %.2fms writes per frame)",
+             static_cast<int>(clock_milli / 60000), (clock_milli - static_cast<int>(clock_milli / 60000) * 60000) / 1000,
+             change.c_str(), this->window_late, this->window_frames, busy_percent, frametime_milli,
+             this->window_bytes / this->window_frames, this->window_write_milli / this->window_frames);
+    this->log.push_back(line);
+}
\ No newline at end of file
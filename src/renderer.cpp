@@ -1,14 +1,33 @@
 #include "renderer.hpp"
+#include "demuxer.hpp"
 
-std::string block_char = "█";
+// full block & upper half block characters, U+2588 & U+2580
+const uint32_t block_glyph = 0x2588;
+const uint32_t upper_half_glyph = 0x2580;
 
 /**
  * @brief Default Renderer constructor
  *
  */
-TermVideo::Renderer::Renderer() {}
+TermVideo::Renderer::Renderer()
+{
+    this->worker_pool = nullptr;
+    this->cast_writer = nullptr;
+#ifdef __USE_FFMPEG
+    this->frame_queue = nullptr;
+    this->decode_serial = 0;
+    this->consecutive_drops = 0;
+#endif
+}
 
-TermVideo::Renderer::~Renderer() {}
+TermVideo::Renderer::~Renderer()
+{
+#ifdef __USE_FFMPEG
+    delete this->frame_queue;
+#endif
+    delete this->worker_pool;
+    delete this->cast_writer;
+}
 
 /**
  * @brief Construct a new Renderer:: Renderer object
@@ -28,10 +47,17 @@ TermVideo::Renderer::Renderer(MediaInfo *info, Options opts)
     this->info->seek_step_ms = opts.seek_step_ms;
 
 #ifdef __USE_FFMPEG
-    this->info->v_sws_ctx = nullptr;
+    this->scaler.set_algorithm(opts.scaler);
+    this->scaler_src_width = this->scaler_src_height = 0;
+    this->frame_queue = nullptr;
+    this->decode_serial = 0;
+    this->consecutive_drops = 0;
 #endif
 
     this->frames_to_skip = opts.frames_to_skip;
+    this->frame_queue_size = opts.frame_queue_size;
+    this->decode_threads = opts.decode_threads;
+    this->decode_thread_type = opts.decode_thread_type;
     this->print_colour = opts.print_colour;
     this->force_aspect = opts.force_aspect;
     this->force_avg_luminance = opts.force_avg_lumi;
@@ -39,17 +65,131 @@ TermVideo::Renderer::Renderer(MediaInfo *info, Options opts)
     this->col_threshold = opts.col_threshold;
     this->filename = opts.filename;
     this->char_set = opts.char_set;
-    this->use_ascii = opts.use_ascii;
+    this->render_mode = opts.render_mode;
+    this->build_subcell_glyphs();
     this->disable_frame_sync = opts.disable_frame_sync;
+    this->use_delta = opts.use_delta;
+    this->colour_depth = opts.colour_depth;
+    this->colour_budget = opts.colour_budget;
+    this->record_path = opts.record_path;
+    this->cast_writer = nullptr;
 
     this->padding_x = this->padding_y = 0;
     this->prev_r = this->prev_g = this->prev_b = 255;
     this->next_frame = std::chrono::steady_clock::now();
-    this->optimiser = Optimiser(col_threshold);
+    this->encoder = FrameEncoder(this->print_colour, this->col_threshold, this->use_delta, this->colour_depth,
+                                 this->render_mode == RenderMode::HalfBlock || this->render_mode == RenderMode::Space,
+                                 this->colour_budget, opts.dither);
+
+    // 0 uses a thread per core
+    int encode_threads = opts.encode_threads;
+    if (encode_threads == 0)
+        encode_threads = std::max(1u, std::thread::hardware_concurrency());
+    this->worker_pool = new WorkerPool(encode_threads);
+    this->encoder.set_worker_pool(this->worker_pool);
+    this->ditherer.set_mode(opts.dither);
     this->perf_checker = PerformanceChecker();
 
+    // colour threshold & depth only change when printing colours
+    this->quality = QualityController({this->col_threshold, this->colour_depth, 100, opts.frames_to_skip},
+                                      {this->print_colour ? static_cast<uchar>(opts.max_threshold) : this->col_threshold,
+                                       this->print_colour ? opts.min_colour_depth : this->colour_depth,
+                                       opts.min_scale, opts.max_skip},
+                                      opts.adaptive_quality);
+    this->output_scale = 100;
+    this->scaled_for_scale = 100;
+
     this->ready = false;
     this->term_resized = false;
+    this->fixed_size = false;
+    this->build_glyph_lut();
+}
+
+/**
+ * @brief Sets how many pixels each cell draws for the render mode, and for the braille,
+ *        quadrant & sextant modes which bit each pixel sets and the glyph of every pattern
+ */
+void TermVideo::Renderer::build_subcell_glyphs()
+{
+    this->cell_pixels_x = 1;
+    this->cell_pixels_y = 1;
+    this->subcell_bits = {};
+    this->subcell_glyphs.clear();
+
+    switch (this->render_mode)
+    {
+    case RenderMode::HalfBlock:
+        this->cell_pixels_y = 2;
+        break;
+
+    case RenderMode::Braille:
+    {
+        // dots 1-3 & 4-6 are the top 3 rows of each column, dots 7 & 8 the bottom row
+        this->cell_pixels_x = 2;
+        this->cell_pixels_y = 4;
+        this->subcell_bits = {{{0x01, 0x08}, {0x02, 0x10}, {0x04, 0x20}, {0x40, 0x80}}};
+
+        this->subcell_glyphs.resize(256);
+        for (uint32_t mask = 0; mask < 256; mask++)
+            this->subcell_glyphs[mask] = 0x2800 + mask;
+        break;
+    }
+
+    case RenderMode::Quadrant:
+    {
+        this->cell_pixels_x = 2;
+        this->cell_pixels_y = 2;
+        this->subcell_bits = {{{0x01, 0x02}, {0x04, 0x08}}};
+
+        // indexed by top left, top right, bottom left & bottom right bits
+        this->subcell_glyphs = {' ', 0x2598, 0x259D, 0x2580, 0x2596, 0x258C, 0x259E, 0x259B,
+                                0x2597, 0x259A, 0x2590, 0x259C, 0x2584, 0x2599, 0x259F, 0x2588};
+        break;
+    }
+
+    case RenderMode::Sextant:
+    {
+        this->cell_pixels_x = 2;
+        this->cell_pixels_y = 3;
+        this->subcell_bits = {{{0x01, 0x02}, {0x04, 0x08}, {0x10, 0x20}}};
+
+        // sextants start at U+1FB00 in pattern order, skipping the patterns that already
+        // exist as the left half, right half & full blocks
+        this->subcell_glyphs.resize(64);
+        for (uint32_t mask = 1; mask < 63; mask++)
+            this->subcell_glyphs[mask] = 0x1FB00 + (mask - 1) - (mask > 21) - (mask > 42);
+        this->subcell_glyphs[21] = 0x258C;
+        this->subcell_glyphs[42] = 0x2590;
+        this->subcell_glyphs[63] = 0x2588;
+        break;
+    }
+
+    default:
+        return;
+    }
+
+    // blank patterns are spaces so their colour is never written
+    if (!this->subcell_glyphs.empty())
+        this->subcell_glyphs[0] = ' ';
+}
+
+/**
+ * @brief Builds the luminance to character lookup table from the character set
+ */
+void TermVideo::Renderer::build_glyph_lut()
+{
+    size_t len = this->char_set.length();
+
+    for (int luminance = 0; luminance < 256; luminance++)
+    {
+        double normalised_luminance = static_cast<double>(luminance) / 255;
+        size_t ascii_index = static_cast<size_t>(normalised_luminance * len);
+
+        if (ascii_index >= len)
+            ascii_index = len - 1;
+
+        this->glyph_lut[luminance] = (len > 0) ? this->char_set[ascii_index] : ' ';
+    }
 }
 
 /**
@@ -63,99 +203,267 @@ TermVideo::Renderer::Renderer(MediaInfo *info, Options opts)
 char TermVideo::Renderer::pixel_to_ascii(uchar pixel_r, uchar pixel_g, uchar pixel_b)
 {
     uchar luminance = get_luminance_approximate(pixel_r, pixel_g, pixel_b, this->force_avg_luminance);
-    double normalised_luminance = static_cast<double>(luminance) / 255;
-
-    // choose a character set to print out
-    std::string ascii_char_set = this->char_set;
-    size_t len = ascii_char_set.length();
-    int ascii_index = static_cast<int>(normalised_luminance * ascii_char_set.length());
-
-    if (ascii_index >= ascii_char_set.length())
-        ascii_index = static_cast<int>(ascii_char_set.length() - 1);
-
-    return ascii_char_set[ascii_index];
+    return this->glyph_lut[luminance];
 }
 
 /**
- * @brief Converts a full frame into a series of ASCII characters
+ * @brief Lays a frame out on the terminal grid, one cell per character including the padding
  *
- * @param ascii_output Frame converted into ASCII string
- * @param frame_pixels Vector of pixels in RGB order
- * @param width Width of the frame
- * @param height Height of the frame
- * @param channels No of colour channels for each pixel
- * @return std::string
+ * @param video_frame Downscaled frame along with the terminal layout it was scaled for
  */
-void TermVideo::Renderer::frame_to_ascii(
-    std::string &ascii_output,
-    uchar *frame_pixels,
-    const int width,
-    const int height,
-    const int channels)
+void TermVideo::Renderer::frame_to_cells(const VideoFrame &video_frame)
 {
-    int td_len = 0;
-    ascii_output = "";
+    if (this->render_mode == RenderMode::HalfBlock)
+    {
+        this->frame_to_half_blocks(video_frame);
+        return;
+    }
+    if (!this->subcell_glyphs.empty())
+    {
+        this->frame_to_subcells(video_frame);
+        return;
+    }
+
+    uchar *frame_pixels = video_frame.pixels;
+    const int term_width = video_frame.term_width,
+              width = std::min(video_frame.width, term_width - video_frame.padding_x),
+              height = std::min(video_frame.height, video_frame.term_height - video_frame.padding_y),
+              channels = video_frame.channels,
+              stride = video_frame.stride;
 
-    // add top padding to fit aspect ratio
-    for (int i = 0; i < this->padding_y; i++)
-        ascii_output += std::string(this->width, ' ');
+    const Kernels &kernels = get_kernels();
+    const bool use_ascii = (this->render_mode == RenderMode::Ascii),
+               use_space = (this->render_mode == RenderMode::Space);
+
+    // padding around the frame to fit aspect ratio stays blank
+    this->cells.assign(term_width * video_frame.term_height, {' ', 0, 0, 0, 0, 0, 0, 0, 0});
+    this->row_luminance.resize(width);
 
     for (int row = 0; row < height; row++)
     {
-        // left padding to fit aspect ratio
-        if (this->force_aspect)
-            ascii_output += std::string(this->padding_x, ' ');
-        if (row == 0 && this->display_frametime)
+        Cell *cell_row = &this->cells[(row + video_frame.padding_y) * term_width + video_frame.padding_x];
+
+        // grayscale frames already hold the luminance, which is also the glyph index
+        const uchar *luminance = frame_pixels + row * stride;
+        if (use_ascii && channels == 3)
         {
-            std::string time_display = std::format("{:.3f}ms", this->perf_checker.last_frame_time_milli);
-            std::string frame_time_str = std::format("\033[38;2;255;255;255m{:.3f}ms", this->perf_checker.last_frame_time_milli);
-            ascii_output += frame_time_str;
-            td_len = time_display.length();
+            kernels.luminance_row(luminance, this->row_luminance.data(), width, this->force_avg_luminance);
+            luminance = this->row_luminance.data();
         }
 
-        for (int col = 0; col < width; col++)
+        // banding between characters of a short set is dithered away
+        if (use_ascii && (channels == 1 || channels == 3) && this->ditherer.is_enabled())
         {
-            if (row == 0 && col < td_len)
-                continue;
+            if (luminance != this->row_luminance.data())
+                std::copy(luminance, luminance + width, this->row_luminance.data());
+            this->ditherer.dither_levels(this->row_luminance.data(), width, 1, row, this->char_set.length());
+            luminance = this->row_luminance.data();
+        }
 
-            ULONG index = channels * (row * width + col);
+        for (int col = 0; col < width; col++)
+        {
+            ULONG index = row * stride + channels * col;
             uchar pixel_b = frame_pixels[index],
-                  pixel_g = frame_pixels[index + 1],
-                  pixel_r = frame_pixels[index + 2];
+                  pixel_g = pixel_b,
+                  pixel_r = pixel_b;
 
-            std::string coord_char = block_char;
-            if (this->use_ascii)
+            if (channels >= 3)
             {
-                char ascii_char = this->pixel_to_ascii(pixel_r, pixel_g, pixel_b);
-                coord_char = std::string(1, ascii_char);
+                pixel_g = frame_pixels[index + 1];
+                pixel_r = frame_pixels[index + 2];
+            }
+
+            if (use_space)
+            {
+                cell_row[col] = {' ', pixel_r, pixel_g, pixel_b, 0, pixel_r, pixel_g, pixel_b, 0};
+                continue;
             }
 
-            // only uses ANSI colours when necessary
-            if (this->print_colour && this->optimiser.should_apply_ansi_col(pixel_r, pixel_g, pixel_b, coord_char))
+            uint32_t glyph = block_glyph;
+            if (use_ascii)
+            {
+                char ascii_char = (channels == 1 || channels == 3) ? this->glyph_lut[luminance[col]]
+                                                                   : this->pixel_to_ascii(pixel_r, pixel_g, pixel_b);
+                glyph = static_cast<uchar>(ascii_char);
+            }
+
+            cell_row[col] = {glyph, pixel_r, pixel_g, pixel_b, 0, 0, 0, 0, 0};
+        }
+    }
+
+    if (height > 0)
+        this->draw_frametime(video_frame);
+}
+
+/**
+ * @brief Lays a frame out on the terminal grid as braille, quadrant or sextant patterns.
+ *        Each pixel of a cell is thresholded into 1 bit of the pattern, in colour the
+ *        pattern is drawn with the average colour of its set pixels
+ *
+ * @param video_frame Downscaled frame along with the terminal layout it was scaled for
+ */
+void TermVideo::Renderer::frame_to_subcells(const VideoFrame &video_frame)
+{
+    uchar *frame_pixels = video_frame.pixels;
+    const int term_width = video_frame.term_width,
+              pixels_y = this->cell_pixels_y,
+              width = std::min(video_frame.width / this->cell_pixels_x, term_width - video_frame.padding_x),
+              rows = std::min(video_frame.height / pixels_y, video_frame.term_height - video_frame.padding_y),
+              channels = video_frame.channels,
+              stride = video_frame.stride;
+
+    // grayscale output is black on white, so dark pixels are the ones drawn
+    const uchar draw_dark = this->print_colour ? 0 : 1;
+
+    this->cells.assign(term_width * video_frame.term_height, {' ', 0, 0, 0, 0, 0, 0, 0, 0});
+    this->subcell_masks.resize(width);
+    this->subcell_sums.resize(width * 4);
+    this->row_luminance.resize(width * 2);
+
+    for (int row = 0; row < rows; row++)
+    {
+        uchar *masks = this->subcell_masks.data();
+        std::fill(this->subcell_masks.begin(), this->subcell_masks.end(), 0);
+        std::fill(this->subcell_sums.begin(), this->subcell_sums.end(), 0);
+
+        for (int y = 0; y < pixels_y; y++)
+        {
+            const uchar *line = frame_pixels + (row * pixels_y + y) * stride;
+            const uchar bit_l = this->subcell_bits[y][0],
+                        bit_r = this->subcell_bits[y][1];
+
+            // the threshold is dithered by treating on & off as 2 levels
+            const int pixel_row = row * pixels_y + y;
+
+            // grayscale frames already hold the luminance, kept branchless so it vectorises
+            if (channels == 1)
             {
-                std::string ascii_col = get_char_ansi_col(pixel_r, pixel_g, pixel_b, coord_char);
-                ascii_output += ascii_col;
+                const uchar *luminance = line;
+                if (this->ditherer.is_enabled())
+                {
+                    std::copy(line, line + width * 2, this->row_luminance.data());
+                    this->ditherer.dither_levels(this->row_luminance.data(), width * 2, 1, pixel_row, 2);
+                    luminance = this->row_luminance.data();
+                }
+
+                for (int col = 0; col < width; col++)
+                {
+                    uchar set_l = (luminance[2 * col] < SUBCELL_THRESHOLD) == draw_dark,
+                          set_r = (luminance[2 * col + 1] < SUBCELL_THRESHOLD) == draw_dark;
+                    masks[col] |= (bit_l & -set_l) | (bit_r & -set_r);
+                }
+                continue;
+            }
+
+            const uchar *luminance = this->row_luminance.data();
+            get_kernels().luminance_row(line, this->row_luminance.data(), width * 2, this->force_avg_luminance);
+            this->ditherer.dither_levels(this->row_luminance.data(), width * 2, 1, pixel_row, 2);
 
-                // updates previous set of pixel colours
-                this->optimiser.set_prev_colours(pixel_r, pixel_g, pixel_b);
+            for (int col = 0; col < width; col++)
+            {
+                for (int x = 0; x < 2; x++)
+                {
+                    const uchar *pixel = line + channels * (2 * col + x);
+                    if ((luminance[2 * col + x] < SUBCELL_THRESHOLD) != draw_dark)
+                        continue;
+
+                    masks[col] |= this->subcell_bits[y][x];
+
+                    uint32_t *sums = &this->subcell_sums[col * 4];
+                    sums[0] += pixel[2];
+                    sums[1] += pixel[1];
+                    sums[2] += pixel[0];
+                    sums[3]++;
+                }
             }
-            else
+        }
+
+        Cell *cell_row = &this->cells[(row + video_frame.padding_y) * term_width + video_frame.padding_x];
+        for (int col = 0; col < width; col++)
+        {
+            Cell &cell = cell_row[col];
+            cell.glyph = this->subcell_glyphs[masks[col]];
+
+            const uint32_t *sums = &this->subcell_sums[col * 4];
+            if (sums[3] > 0)
             {
-                ascii_output += coord_char;
+                cell.r = static_cast<uchar>(sums[0] / sums[3]);
+                cell.g = static_cast<uchar>(sums[1] / sums[3]);
+                cell.b = static_cast<uchar>(sums[2] / sums[3]);
             }
         }
+    }
 
-        // right padding to extend to next line
-        if (this->force_aspect)
+    if (rows > 0)
+        this->draw_frametime(video_frame);
+}
+
+/**
+ * @brief Draws the last frame time in white over the top left of the frame
+ *
+ * @param video_frame Frame being presented
+ */
+void TermVideo::Renderer::draw_frametime(const VideoFrame &video_frame)
+{
+    if (!this->display_frametime)
+        return;
+
+    const int term_width = video_frame.term_width;
+    char time_display[32];
+    int td_len = snprintf(time_display, sizeof(time_display), "%.3fms", this->perf_checker.last_frame_time_milli);
+    td_len = std::clamp(td_len, 0, std::min<int>(sizeof(time_display) - 1, term_width - video_frame.padding_x));
+
+    Cell *cell_row = &this->cells[video_frame.padding_y * term_width + video_frame.padding_x];
+    for (int col = 0; col < td_len; col++)
+        cell_row[col] = {static_cast<uchar>(time_display[col]), 255, 255, 255, 0, 0, 0, 0, 0};
+}
+
+/**
+ * @brief Lays a frame out on the terminal grid as upper half blocks, the top pixel of each
+ *        cell is the foreground colour and the bottom pixel is the background colour
+ *
+ * @param video_frame Downscaled BGR frame along with the terminal layout it was scaled for
+ */
+void TermVideo::Renderer::frame_to_half_blocks(const VideoFrame &video_frame)
+{
+    uchar *frame_pixels = video_frame.pixels;
+    const int term_width = video_frame.term_width,
+              width = std::min(video_frame.width, term_width - video_frame.padding_x),
+              rows = std::min(video_frame.height / 2, video_frame.term_height - video_frame.padding_y),
+              channels = video_frame.channels,
+              stride = video_frame.stride;
+
+    this->cells.assign(term_width * video_frame.term_height, {' ', 0, 0, 0, 0, 0, 0, 0, 0});
+
+    for (int row = 0; row < rows; row++)
+    {
+        Cell *cell_row = &this->cells[(row + video_frame.padding_y) * term_width + video_frame.padding_x];
+        const uchar *top = frame_pixels + (2 * row) * stride,
+                    *bottom = top + stride;
+
+        for (int col = 0; col < width; col++)
         {
-            int rem_len = this->width - width - this->padding_x;
-            ascii_output += std::string(rem_len, ' ');
+            const uchar *upper = top + channels * col,
+                        *lower = bottom + channels * col;
+            cell_row[col] = {upper_half_glyph, upper[2], upper[1], upper[0], 0, lower[2], lower[1], lower[0], 0};
         }
     }
 
-    // add bottom padding to fit aspect ratio
-    for (int i = 0; i < (this->height - this->padding_y - height); i++)
-        ascii_output += std::string(this->width, ' ');
+    if (rows > 0)
+        this->draw_frametime(video_frame);
+}
+
+/**
+ * @brief Converts a full frame into a series of ASCII characters
+ *
+ * @param ascii_output Frame converted into ASCII string, only the changed characters when
+ *                     delta rendering
+ * @param video_frame Downscaled frame along with the terminal layout it was scaled for
+ */
+void TermVideo::Renderer::frame_to_ascii(std::string &ascii_output, const VideoFrame &video_frame)
+{
+    this->frame_to_cells(video_frame);
+    this->encoder.encode(this->cells, video_frame.term_width, video_frame.term_height, ascii_output);
 }
 
 #if defined(__USE_OPENCV)
@@ -165,27 +473,29 @@ void TermVideo::Renderer::frame_to_ascii(
  */
 void TermVideo::Renderer::frame_downscale_opencv(cv::Mat &frame)
 {
-    const int max_width = this->width,
-              max_height = this->height;
+    // each cell draws cell_pixels_x by cell_pixels_y pixels
+    const int max_width = this->width * this->cell_pixels_x,
+              max_height = this->height * this->cell_pixels_y;
+    const double pixel_aspect = 2.0 * this->cell_pixels_x / this->cell_pixels_y;
 
     int new_width = frame.cols,
         new_height = frame.rows;
 
     // if forcing aspect ration & resizing by height first
-    if (this->force_aspect && frame.rows > this->height)
+    if (this->force_aspect && frame.rows > max_height)
     {
-        new_height = this->height;
+        new_height = max_height;
         new_width = static_cast<int>(std::min(
-            static_cast<double>(this->width),
-            static_cast<double>(frame.cols) * (static_cast<double>(this->height) / frame.rows) * 2));
-        this->padding_x = (this->width - new_width);
+            static_cast<double>(max_width),
+            static_cast<double>(frame.cols) * (static_cast<double>(max_height) / frame.rows) * pixel_aspect));
+        this->padding_x = (this->width - new_width / this->cell_pixels_x);
         this->padding_x = (this->padding_x / 2) + (this->padding_x & 1);
     }
 
     else if (frame.cols > max_width)
     {
-        new_width = this->width;
-        new_height = this->height;
+        new_width = max_width;
+        new_height = max_height;
     }
 
     if (new_width != frame.cols && new_height != frame.rows)
@@ -199,104 +509,124 @@ void TermVideo::Renderer::frame_downscale_opencv(cv::Mat &frame)
 /**
  * @brief Downscales a frame to better fix ASCII characters & size. Uses ffmpeg.
  * @param frame Frame to be downscaled
+ * @param scaled_frame Persistent destination image, only reallocated when the output size changes
+ * @return bool Whether the frame was scaled
  */
-void TermVideo::Renderer::frame_downscale_ffmpeg(AVFrame *frame)
+bool TermVideo::Renderer::frame_downscale_ffmpeg(AVFrame *frame, AVFrame *scaled_frame)
 {
-    AVPixelFormat output_format = AV_PIX_FMT_BGR24;
-
-    // create scaler if doesn't exist or terminal has been resized
-    if (this->info->v_sws_ctx == nullptr || this->term_resized)
+    // without colour, only luminance is needed which swscale takes straight from
+    // the Y plane for YUV sources. Average luminance still needs all 3 channels
+    bool grayscale = !this->print_colour && !this->force_avg_luminance;
+    AVPixelFormat output_format = grayscale ? AV_PIX_FMT_GRAY8 : AV_PIX_FMT_BGR24;
+
+    // work out the output size if the terminal, the video or the output scale has changed
+    const int scale = this->output_scale;
+    if (this->term_resized || frame->width != this->scaler_src_width || frame->height != this->scaler_src_height ||
+        scale != this->scaled_for_scale)
     {
-        this->padding_x = 0;
-        this->padding_y = 0;
+        // each cell draws cell_pixels_x by cell_pixels_y pixels, a lowered output scale
+        // leaves a border of blank cells around the frame
+        const int scaled_width = std::max(1, this->width * scale / 100),
+                  scaled_height = std::max(1, this->height * scale / 100);
+        this->padding_x = (this->width - scaled_width) / 2;
+        this->padding_y = (this->height - scaled_height) / 2;
+        const int max_width = scaled_width * this->cell_pixels_x,
+                  max_height = scaled_height * this->cell_pixels_y;
 
         int new_width = frame->width,
             new_height = frame->height;
 
-        double terminal_aspect = static_cast<double>(this->width) / (static_cast<double>(this->height) * 2);
+        // NOTE: For the aspect ratio resizing, video_aspect is multiplied by the pixel
+        // aspect, a terminal character is 2:1 in height:width so a pixel is
+        // (2 / cell_pixels_y):(1 / cell_pixels_x). That's 2 for 1 pixel per character
+        // and 1 for half blocks
+        double pixel_aspect = 2.0 * this->cell_pixels_x / this->cell_pixels_y;
+        double terminal_aspect = static_cast<double>(max_width) / (static_cast<double>(max_height) * pixel_aspect);
         double video_aspect = static_cast<double>(frame->width) / static_cast<double>(frame->height);
 
-        // NOTE: For the aspect ratio resizing, video_aspect is multiplied
-        // by 2 as the pixel sizes for a terminal character is 2:1 in height:width
-
         // if forcing video's aspect ratio and its ratio is greater than terminal's
         // i.e. it's "wider" than the terminal, use y padding
         if (this->force_aspect && video_aspect > terminal_aspect)
         {
-            new_width = this->width;
+            new_width = max_width;
             new_height = static_cast<int>(
                 std::min(
-                    static_cast<double>(this->height),
-                    (static_cast<double>(this->width) / (video_aspect * 2))));
-            this->padding_y = this->height - new_height;
+                    static_cast<double>(max_height),
+                    (static_cast<double>(max_width) / (video_aspect * pixel_aspect))));
+
+            // whole cells only, padding is counted in cells
+            new_height -= new_height % this->cell_pixels_y;
+            this->padding_y = this->height - new_height / this->cell_pixels_y;
             this->padding_y = (this->padding_y / 2);
         }
         // if forcing video's aspect ratio and its ratio is less than terminal's
         // i.e. it's "taller" than the terminal, use x padding
         else if (this->force_aspect && video_aspect < terminal_aspect)
         {
-            new_height = this->height;
+            new_height = max_height;
             new_width = static_cast<int>(std::min(
-                static_cast<double>(this->width),
-                static_cast<double>(this->height * video_aspect * 2)));
-            this->padding_x = this->width - new_width;
+                static_cast<double>(max_width),
+                static_cast<double>(max_height * video_aspect * pixel_aspect)));
+
+            new_width -= new_width % this->cell_pixels_x;
+            this->padding_x = this->width - new_width / this->cell_pixels_x;
             this->padding_x = (this->padding_x / 2);
         }
         // default case, fit to terminal size
         else
         {
-            new_width = this->width;
-            new_height = this->height;
+            new_width = max_width;
+            new_height = max_height;
         }
 
-        this->info->colour_channels = 3;
+        this->info->colour_channels = grayscale ? 1 : 3;
         this->info->new_width = new_width;
         this->info->new_height = new_height;
-        this->info->v_sws_ctx = sws_getContext(
-            frame->width, frame->height, static_cast<AVPixelFormat>(frame->format),
-            new_width, new_height, output_format,
-            SWS_BILINEAR,
-            nullptr, nullptr, nullptr);
+        this->scaler_src_width = frame->width;
+        this->scaler_src_height = frame->height;
+        this->scaled_for_scale = scale;
 
         this->term_resized = false;
     }
 
-    if (this->info->new_width != frame->width && this->info->new_height != frame->height)
+    // reuse the destination image unless the terminal has been resized, default
+    // alignment keeps swscale on its SIMD paths
+    if (scaled_frame->width != this->info->new_width ||
+        scaled_frame->height != this->info->new_height ||
+        scaled_frame->format != output_format)
     {
-        AVFrame *resized_frame = av_frame_alloc();
-        resized_frame->format = output_format;
-        resized_frame->width = this->info->new_width;
-        resized_frame->height = this->info->new_height;
-
-        if (av_frame_get_buffer(resized_frame, 1) < 0)
-            return;
-
-        sws_scale(this->info->v_sws_ctx,
-                  frame->data, frame->linesize,
-                  0, frame->height,
-                  resized_frame->data, resized_frame->linesize);
+        av_frame_unref(scaled_frame);
+        scaled_frame->format = output_format;
+        scaled_frame->width = this->info->new_width;
+        scaled_frame->height = this->info->new_height;
 
-        av_frame_unref(frame);
-        *frame = *resized_frame;
+        if (av_frame_get_buffer(scaled_frame, 0) < 0)
+        {
+            av_frame_unref(scaled_frame);
+            return false;
+        }
     }
+
+    return this->scaler.scale(frame, scaled_frame);
 }
 #endif
 
-void TermVideo::Renderer::print(std::string ascii_frame)
+/**
+ * @brief Writes a frame to the terminal and records how long it took
+ *
+ * @param ascii_frame Bytes of the frame, positioning the cursor itself
+ */
+void TermVideo::Renderer::print(const std::string &ascii_frame)
 {
 #if defined(_WIN32)
     SetConsoleCursorPosition(GetStdHandle(STD_OUTPUT_HANDLE), {0, 0});
-#elif defined(__linux__)
-    move(0, 0);
-    refresh();
 #endif
 
-    // https://stackoverflow.com/questions/51149880/fprintf-fputs-vs-cout-performance-for-large-strings
-    auto frame_len = ascii_frame.length();
-    if (frame_len <= 30000)
-        fputs(ascii_frame.c_str(), stdout);
-    else
-        fwrite(ascii_frame.c_str(), frame_len, 1, stdout);
+    if (!this->writer.write_frame(ascii_frame))
+        return;
+
+    this->perf_checker.add_frame_bytes(this->writer.get_last_write_bytes());
+    this->perf_checker.add_write_time(this->writer.get_last_write_time_milli());
 }
 
 /**
@@ -305,12 +635,17 @@ void TermVideo::Renderer::print(std::string ascii_frame)
 void TermVideo::Renderer::wait_for_frame()
 {
     if (this->disable_frame_sync)
+    {
+        this->update_quality(0);
         return;
+    }
 
     // Use audio clock as master when audio is enabled
     if (this->info->a_clock_ms > 0)
     {
         int64_t ahead_ms = this->info->v_clock_ms - this->info->a_clock_ms;
+        this->update_quality(static_cast<double>(-ahead_ms));
+
         if (ahead_ms > 100)
             std::this_thread::sleep_for(std::chrono::milliseconds(ahead_ms / 2));
         else if (ahead_ms > 0)
@@ -320,10 +655,45 @@ void TermVideo::Renderer::wait_for_frame()
     else
     {
         this->next_frame += std::chrono::nanoseconds(this->info->frametime_ns);
+        auto now = std::chrono::steady_clock::now();
+        if (now > this->next_frame)
+            this->perf_checker.add_late_frame();
+
+        this->update_quality(std::chrono::duration<double, std::milli>(now - this->next_frame).count());
+
         std::this_thread::sleep_until(this->next_frame);
     }
 }
 
+/**
+ * @brief Passes the last frame's measurements to the quality controller and applies
+ *        whatever it adjusted
+ *
+ * @param late_ms How far past its deadline the frame was presented, negative when early
+ */
+void TermVideo::Renderer::update_quality(double late_ms)
+{
+    const double frametime_ms = this->info->frametime_ns / 1e6;
+    if (!this->quality.add_frame(this->writer.get_last_write_bytes(), this->writer.get_last_write_time_milli(),
+                                 this->perf_checker.last_frame_time_milli, late_ms, frametime_ms, this->info->v_clock_ms))
+        return;
+
+    const QualitySettings &settings = this->quality.get_settings();
+    this->col_threshold = settings.col_threshold;
+    this->colour_depth = settings.colour_depth;
+    this->encoder.set_colour_threshold(settings.col_threshold);
+    this->encoder.set_colour_depth(settings.colour_depth);
+    this->output_scale = settings.scale_percent;
+
+    // frame time covers every skipped frame as well
+    int frames_to_skip = this->frames_to_skip;
+    if (settings.frames_to_skip != frames_to_skip)
+    {
+        this->info->frametime_ns = this->info->frametime_ns / (1 + frames_to_skip) * (1 + settings.frames_to_skip);
+        this->frames_to_skip = settings.frames_to_skip;
+    }
+}
+
 #if defined(__USE_OPENCV)
 /**
  * @brief Converts a video into ASCII frames. Uses opencv4
@@ -350,15 +720,22 @@ void TermVideo::Renderer::process_video_opencv()
         // reduces video resolution to fit the terminal
         this->frame_downscale_opencv(frame);
 
-        // convert pixels and store to ascii_frame
-        std::string ascii_frame;
-        this->frame_to_ascii(ascii_frame, frame.data, frame.cols, frame.rows, frame.channels());
+        VideoFrame video_frame;
+        video_frame.pixels = frame.data;
+        video_frame.stride = static_cast<int>(frame.step);
+        video_frame.width = frame.cols;
+        video_frame.height = frame.rows;
+        video_frame.channels = frame.channels();
+        video_frame.term_width = this->width;
+        video_frame.term_height = this->height;
+        video_frame.padding_x = this->padding_x;
+        video_frame.padding_y = this->padding_y;
 
-        // properly print output frame
-        this->print(ascii_frame);
+        // convert pixels and print output frame
+        this->present_frame(video_frame);
 
         // refetch terminal size every interval
-        if (frame_count % FETCH_TERMINAL_INTERVAL == 0)
+        if (frame_count % FETCH_TERMINAL_INTERVAL == 0 && !this->fixed_size)
             get_terminal_size(this->width, this->height, this->term_resized);
 
         // wait for next interval before processing
@@ -367,96 +744,381 @@ void TermVideo::Renderer::process_video_opencv()
 }
 #elif defined(__USE_FFMPEG)
 /**
- * @brief Converts a video into ASCII frames. Uses FFmpeg
+ * @brief Downscales a decoded frame and hands it over to the presenter
+ *
+ * @param frame Decoded frame, its contents are moved into the queue
+ * @return bool False if the presenter has stopped
+ */
+bool TermVideo::Renderer::queue_frame(AVFrame *frame)
+{
+    // blocks while the presenter is behind, returns nullptr once it stops
+    VideoFrame *video_frame = this->frame_queue->begin_write();
+    if (video_frame == nullptr)
+    {
+        av_frame_unref(frame);
+        return false;
+    }
+
+    // reduces video resolution to fit the terminal, straight into the queued slot
+    bool scaled = this->frame_downscale_ffmpeg(frame, video_frame->frame);
+
+    auto time_unit = av_q2d(this->info->v_stream->time_base);
+    double pts_ms = frame->best_effort_timestamp * time_unit * 1000;
+    av_frame_unref(frame);
+
+    if (!scaled)
+        return true;
+
+    video_frame->pixels = video_frame->frame->data[0];
+    video_frame->stride = video_frame->frame->linesize[0];
+    video_frame->width = video_frame->frame->width;
+    video_frame->height = video_frame->frame->height;
+    video_frame->channels = this->info->colour_channels;
+    video_frame->term_width = this->width;
+    video_frame->term_height = this->height;
+    video_frame->padding_x = this->padding_x;
+    video_frame->padding_y = this->padding_y;
+    video_frame->pts_ms = pts_ms;
+    video_frame->serial = this->decode_serial;
+
+    this->frame_queue->end_write();
+    return true;
+}
+
+/**
+ * @brief Tells the decoder to skip frames while decoded video lags behind the audio clock,
+ *        skipping non-reference frames first and everything but keyframes when further behind.
+ *        Frames keep being skipped until the video has caught up
+ *
+ * @param decode_clock_ms Timestamp of the last decoded frame
  */
-void TermVideo::Renderer::process_video_ffmpeg()
+void TermVideo::Renderer::update_frame_discard(double decode_clock_ms)
+{
+    AVCodecContext *codec_ctx = this->info->v_codec_ctx;
+    AVDiscard discard = AVDISCARD_DEFAULT;
+
+    // only the audio clock can tell whether video is behind
+    if (!this->disable_frame_sync && this->info->a_clock_ms > 0)
+    {
+        double lag_ms = this->info->a_clock_ms - decode_clock_ms;
+
+        if (lag_ms > DISCARD_NONKEY_LAG_MS)
+            discard = AVDISCARD_NONKEY;
+        else if (lag_ms > DISCARD_NONREF_LAG_MS)
+            discard = AVDISCARD_NONREF;
+        else if (lag_ms > 0)
+            discard = codec_ctx->skip_frame;
+    }
+
+    codec_ctx->skip_frame = discard;
+}
+
+/**
+ * @brief Checks whether a queued frame is too far behind the audio clock to be worth presenting
+ *
+ * @param video_frame Frame about to be presented
+ * @return bool Whether to drop the frame
+ */
+bool TermVideo::Renderer::should_drop_frame(const VideoFrame &video_frame)
+{
+    if (this->disable_frame_sync || this->info->a_clock_ms <= 0)
+        return false;
+
+    double lag_ms = this->info->a_clock_ms - video_frame.pts_ms;
+    double frametime_ms = this->info->frametime_ns / 1e6;
+
+    if (lag_ms > PRESENT_DROP_LAG_MS && this->consecutive_drops < MAX_CONSECUTIVE_DROPS)
+    {
+        this->consecutive_drops++;
+        return true;
+    }
+
+    if (lag_ms > frametime_ms)
+        this->perf_checker.add_late_frame();
+
+    this->consecutive_drops = 0;
+    return false;
+}
+
+/**
+ * @brief Decodes and downscales video frames into the frame queue. Runs on its own thread
+ *        so slow terminal writes never stall decoding
+ */
+void TermVideo::Renderer::decode_video_ffmpeg()
 {
     AVFrame *frame = av_frame_alloc();
-    AVPacket packet;
+    AVPacket *packet = av_packet_alloc();
 
     int frame_count = 0;
     int skip_count = 0;
-    this->info->v_clock_ms = 0;
+    int serial = 0;
+    bool presenting = true;
 
-    while (1)
+    // packets sent & frames received while the decoder was skipping frames
+    double decode_clock_ms = 0;
+    int64 discard_packets = 0, discard_frames = 0;
+
+    while (presenting)
     {
-        this->perf_checker.start_frame_time();
+        bool has_packet = this->info->v_packets->get(packet, serial) > 0;
 
-        if (this->info->v_seek.req)
-            this->seek(this->info->v_seek);
+        // demuxer has seeked, the packet comes from the new position
+        if (has_packet && serial != this->decode_serial)
+        {
+            this->seek(this->info->seek);
+            this->decode_serial = serial;
+            decode_clock_ms = this->info->seek.pos;
+        }
 
-        int ret = av_read_frame(this->info->v_format_ctx, &packet);
-        if (ret < 0)
-            break;
+        this->update_frame_discard(decode_clock_ms);
+        bool discarding = this->info->v_codec_ctx->skip_frame != AVDISCARD_DEFAULT;
 
-        // skips if stream isn't the main video
-        // or if there are errors with decoding the packet
-        // or just a general frame skip for optimisation
-        if (packet.stream_index != this->info->v_stream->index ||
-            avcodec_send_packet(this->info->v_codec_ctx, &packet) ||
-            avcodec_receive_frame(this->info->v_codec_ctx, frame) ||
-            skip_count++ < this->frames_to_skip)
+        // at end of file, an empty packet drains the frames still held by the decoder
+        if (!has_packet)
+            avcodec_send_packet(this->info->v_codec_ctx, nullptr);
+        // skips if there are errors with decoding the packet
+        else if (avcodec_send_packet(this->info->v_codec_ctx, packet))
         {
-            av_packet_unref(&packet);
-            av_frame_unref(frame);
+            av_packet_unref(packet);
             continue;
         }
+        else if (discarding)
+            discard_packets++;
 
-        skip_count = 0;
+        av_packet_unref(packet);
 
-        // keep track of current video time
-        auto time_unit = av_q2d(this->info->v_stream->time_base);
-        this->info->v_clock_ms = frame->best_effort_timestamp * time_unit * 1000;
+        // a packet can produce zero or several frames, with frame threading the decoder
+        // holds on to the first few packets before returning anything
+        while (presenting && !avcodec_receive_frame(this->info->v_codec_ctx, frame))
+        {
+            auto time_unit = av_q2d(this->info->v_stream->time_base);
+            decode_clock_ms = frame->best_effort_timestamp * time_unit * 1000;
+            if (discarding)
+                discard_frames++;
 
-        // reduces video resolution to fit the terminal
-        this->frame_downscale_ffmpeg(frame);
+            // general frame skip for optimisation
+            if (skip_count++ < this->frames_to_skip)
+            {
+                av_frame_unref(frame);
+                continue;
+            }
 
-        // convert pixels and store to ascii_frame
-        std::string ascii_frame;
-        this->frame_to_ascii(
-            ascii_frame,
-            frame->data[0],
-            frame->width, frame->height,
-            this->info->colour_channels);
+            skip_count = 0;
 
-        // properly print output frame
-        this->print(ascii_frame);
+            // refetch terminal size every interval
+            if (frame_count++ % FETCH_TERMINAL_INTERVAL == 0 && !this->fixed_size)
+                get_terminal_size(this->width, this->height, this->term_resized);
 
-        av_frame_unref(frame);
-        av_packet_unref(&packet);
+            presenting = this->queue_frame(frame);
+        }
 
-        // refetch terminal size every interval
-        if (++frame_count % FETCH_TERMINAL_INTERVAL == 0)
-            get_terminal_size(this->width, this->height, this->term_resized);
+        if (!has_packet)
+            break;
+    }
+
+    this->frame_queue->close();
+    this->perf_checker.add_discarded_frames(std::max<int64>(0, discard_packets - discard_frames));
+
+    av_frame_free(&frame);
+    av_packet_free(&packet);
+}
+
+/**
+ * @brief Converts a video into ASCII frames. Uses FFmpeg. Decoding runs on a separate
+ *        thread while this one only presents queued frames on schedule
+ */
+void TermVideo::Renderer::process_video_ffmpeg()
+{
+    this->info->v_clock_ms = 0;
+    this->frame_queue = new FrameQueue<VideoFrame>(this->frame_queue_size);
+    for (VideoFrame &slot : this->frame_queue->get_slots())
+        slot.frame = av_frame_alloc();
+
+    std::thread decode_thread(&Renderer::decode_video_ffmpeg, this);
+
+    while (1)
+    {
+        VideoFrame *video_frame = this->frame_queue->begin_read();
+        if (video_frame == nullptr)
+            break;
+
+        // drop frames decoded before the latest seek
+        if (video_frame->serial != this->info->v_packets->get_serial())
+        {
+            this->frame_queue->end_read();
+            continue;
+        }
+
+        // drop frames that are too late to catch up with the audio
+        if (this->should_drop_frame(*video_frame))
+        {
+            this->perf_checker.add_dropped_frame();
+            this->frame_queue->end_read();
+            continue;
+        }
+
+        this->perf_checker.start_frame_time();
+
+        // keep track of current video time
+        this->info->v_clock_ms = video_frame->pts_ms;
+
+        // convert pixels and print output frame
+        this->present_frame(*video_frame);
+        this->frame_queue->end_read();
 
         this->perf_checker.end_frame_time();
         this->wait_for_frame();
     }
+
+    decode_thread.join();
+
+    for (VideoFrame &slot : this->frame_queue->get_slots())
+        av_frame_free(&slot.frame);
 }
 #endif
 
-void TermVideo::Renderer::seek(Seek seek_info)
+/**
+ * @brief Converts a queued frame to text and prints it out
+ *
+ * @param video_frame Frame to be presented
+ */
+void TermVideo::Renderer::present_frame(VideoFrame &video_frame)
 {
-#if defined(__USE_OPENCV)
-    this->cap->set(cv::CAP_PROP_POS_MSEC, this->info->time_pt_ms);
-#elif defined(__USE_FFMPEG)
+    this->frame_to_ascii(this->frame_output, video_frame);
+    this->record_frame(video_frame);
+    this->print(this->frame_output);
+}
 
-    int64_t time_u = this->info->v_stream->time_base.den;
-    int64_t timestamp = (seek_info.pos * time_u) / 1000;
+/**
+ * @brief Starts recording to the record path if one is set, the recording starts on a
+ *        cleared screen in the default colours the frames are drawn over
+ */
+void TermVideo::Renderer::open_recording()
+{
+    if (this->record_path.length() == 0)
+        return;
 
-    if (timestamp < 0)
-        timestamp = 0;
+    this->cast_writer = new CastWriter();
+    std::string res = this->cast_writer->open(this->record_path, this->width, this->height, this->filename);
+    if (res.length() > 0)
+    {
+        std::cerr << res << std::endl;
+        delete this->cast_writer;
+        this->cast_writer = nullptr;
+        this->ready = false;
+        return;
+    }
 
-    int ret = av_seek_frame(this->info->v_format_ctx,
-                            this->info->v_stream->index,
-                            timestamp,
-                            seek_info.flags);
-    avcodec_flush_buffers(this->info->v_codec_ctx);
+    this->cast_time_ms = this->cast_pts_ms = 0;
+    this->cast_serial = -1;
+    this->cast_width = this->width;
+    this->cast_height = this->height;
+    this->cast_writer->add_output(0, "\033[?25l" + get_terminal_col(this->print_colour, this->colour_depth) + "\033[2J");
+}
+
+/**
+ * @brief Queues the last frame's text in the recording, timed by the frame's timestamp
+ *
+ * @param video_frame Frame the text was made from
+ */
+void TermVideo::Renderer::record_frame(const VideoFrame &video_frame)
+{
+    if (this->cast_writer == nullptr)
+        return;
+
+    // after a seek the timestamps jump, the recording moves on by a frame instead
+    if (this->cast_serial >= 0)
+    {
+        double step_ms = video_frame.pts_ms - this->cast_pts_ms;
+        if (video_frame.serial != this->cast_serial || step_ms < 0)
+            step_ms = this->info->frametime_ns / 1e6;
+        this->cast_time_ms += step_ms;
+    }
+    this->cast_pts_ms = video_frame.pts_ms;
+    this->cast_serial = video_frame.serial;
+
+    if (video_frame.term_width != this->cast_width || video_frame.term_height != this->cast_height)
+    {
+        this->cast_width = video_frame.term_width;
+        this->cast_height = video_frame.term_height;
+        this->cast_writer->add_resize(this->cast_time_ms, this->cast_width, this->cast_height);
+    }
+
+    this->cast_writer->add_output(this->cast_time_ms, this->frame_output);
+}
 
-    this->info->v_clock_ms = seek_info.pos;
+/**
+ * @brief Writes the rest of the recording, waiting for the writer thread to finish
+ */
+void TermVideo::Renderer::close_recording()
+{
+    if (this->cast_writer == nullptr)
+        return;
+
+    std::string res = this->cast_writer->close();
+    if (res.length() > 0)
+        std::cerr << res << " to " << this->record_path << std::endl;
+    else
+        std::cout << "Recorded " << this->cast_writer->get_event_count() << " events (" << this->cast_time_ms / 1000.0
+                  << "s) to " << this->record_path << ", recorder stalls: " << this->cast_writer->get_stalls() << std::endl;
+
+    delete this->cast_writer;
+    this->cast_writer = nullptr;
+}
+
+/**
+ * @brief Prints performance stats after finishing video
+ */
+void TermVideo::Renderer::print_stats()
+{
+    if (this->decoder_summary.length() > 0)
+        std::cout << this->decoder_summary << std::endl;
+
+    double avg_time = this->perf_checker.get_avg_frame_time_milli();
+    std::cout << "Average frame time: " << avg_time << "ms" << std::endl;
+    std::cout << "Late frames: " << this->perf_checker.get_late_frames()
+              << ", dropped frames: " << this->perf_checker.get_dropped_frames()
+              << ", skipped by decoder: " << this->perf_checker.get_discarded_frames() << std::endl;
+    std::cout << "Average output: " << this->perf_checker.get_avg_frame_bytes() << " bytes/frame"
+              << " (" << (this->print_colour ? std::to_string(this->colour_depth) + " colour" : "no colour") << ")"
+              << ", delta frames: " << this->encoder.get_delta_frames()
+              << ", full repaints: " << this->encoder.get_full_frames() << std::endl;
+    std::cout << "Average write: " << this->perf_checker.get_avg_write_time_milli() << "ms"
+              << ", longest write: " << this->perf_checker.get_max_write_time_milli() << "ms"
+              << ", synchronized output: " << (this->writer.is_sync_supported() ? "on" : "off") << std::endl;
+
+    const std::vector<std::string> &quality_log = this->quality.get_log();
+    if (!quality_log.empty())
+        std::cout << "Quality adjustments:" << std::endl;
+    for (const std::string &line : quality_log)
+        std::cout << "  " << line << std::endl;
+    if (this->encoder.is_budget_used())
+        std::cout << "Colour budget: " << this->encoder.get_avg_budget_bytes_saved() << " bytes/frame saved"
+                  << ", mean error: " << this->encoder.get_mean_budget_error() << std::endl;
+
+#ifdef __USE_FFMPEG
+    if (this->frame_queue == nullptr)
+        return;
+
+    // decoder stalls mean output is the bottleneck, presenter stalls mean decoding is
+    std::cout << "Frame queue: average depth " << this->frame_queue->get_avg_depth()
+              << "/" << this->frame_queue->get_capacity()
+              << ", decoder stalls (queue full): " << this->frame_queue->get_producer_stalls()
+              << ", presenter stalls (queue empty): " << this->frame_queue->get_consumer_stalls()
+              << std::endl;
 #endif
+}
 
-    this->info->v_seek.req = false;
+void TermVideo::Renderer::seek(Seek seek_info)
+{
+#if defined(__USE_OPENCV)
+    this->cap->set(cv::CAP_PROP_POS_MSEC, this->info->time_pt_ms);
+    this->info->seek.req = false;
+#elif defined(__USE_FFMPEG)
+    // the demuxer has already seeked, drop what the decoder held from before it
+    avcodec_flush_buffers(this->info->v_codec_ctx);
+    this->info->v_clock_ms = std::max(seek_info.pos, 0.0);
+#endif
 }
 
 /**
@@ -467,7 +1129,10 @@ void TermVideo::Renderer::init_renderer()
     set_terminal_title(this->filename);
     hide_terminal_cursor();
     get_terminal_size(this->width, this->height, this->term_resized);
-    init_terminal_col(this->print_colour);
+    init_terminal_col(this->print_colour, this->colour_depth);
+
+    // queries the terminal before ncurses takes over its modes
+    this->writer.open();
 
 #ifdef __USE_OPENCV
     cv::utils::logging::setLogLevel(cv::utils::logging::LogLevel::LOG_LEVEL_SILENT);
@@ -482,6 +1147,7 @@ void TermVideo::Renderer::init_renderer()
 #endif
 
     this->ready = true;
+    this->open_recording();
 }
 
 #ifdef __USE_FFMPEG
@@ -498,30 +1164,37 @@ std::string TermVideo::Renderer::get_decoder()
     this->info->v_codec_ctx = avcodec_alloc_context3(this->info->v_decoder);
     avcodec_parameters_to_context(this->info->v_codec_ctx, this->info->v_stream->codecpar);
 
+    // 0 threads lets FFmpeg use one per core, thread type defaults to both frame & slice
+    this->info->v_codec_ctx->thread_count = this->decode_threads;
+    if (this->decode_thread_type == "frame")
+        this->info->v_codec_ctx->thread_type = FF_THREAD_FRAME;
+    else if (this->decode_thread_type == "slice")
+        this->info->v_codec_ctx->thread_type = FF_THREAD_SLICE;
+
     int ret = avcodec_open2(this->info->v_codec_ctx, this->info->v_decoder, nullptr);
     if (ret < 0)
         return "Decoder could not be opened";
 
+    // the codec may not support the requested threading, report what it settled on
+    int active_type = this->info->v_codec_ctx->active_thread_type;
+    std::string thread_type = (active_type & FF_THREAD_FRAME)   ? "frame"
+                              : (active_type & FF_THREAD_SLICE) ? "slice"
+                                                                : "no";
+    this->decoder_summary = std::string("Video decoder: ") + this->info->v_decoder->name + ", " +
+                            std::to_string(this->info->v_codec_ctx->thread_count) + " thread(s), " +
+                            thread_type + " threading";
+
     return "";
 }
 
 /**
- * @brief Opens input stream to video file set in constructor
+ * @brief Picks the video stream from the file opened by the demuxer
  * @return std::string Error string
  */
-std::string TermVideo::Renderer::open_file()
+std::string TermVideo::Renderer::get_video_stream()
 {
-    this->info->v_format_ctx = nullptr;
-    int ret = avformat_open_input(&this->info->v_format_ctx, this->filename.c_str(), nullptr, nullptr);
-    if (ret < 0)
-        return "Unable to open media file!";
-
-    ret = avformat_find_stream_info(this->info->v_format_ctx, nullptr);
-    if (ret < 0)
-        return "Unable to find stream info!";
-
     int stream_index = av_find_best_stream(
-        this->info->v_format_ctx,
+        this->info->format_ctx,
         AVMEDIA_TYPE_VIDEO,
         -1,
         -1,
@@ -530,7 +1203,7 @@ std::string TermVideo::Renderer::open_file()
     if (stream_index < 0)
         return "No video streams found in file!";
 
-    this->info->v_stream = this->info->v_format_ctx->streams[stream_index];
+    this->info->v_stream = this->info->format_ctx->streams[stream_index];
     return "";
 }
 #endif
@@ -552,7 +1225,8 @@ void TermVideo::Renderer::start_renderer()
     this->process_video_ffmpeg();
 #endif
 
+    this->close_recording();
+
     // prints performance after finishing video
-    double avg_time = this->perf_checker.get_avg_frame_time_milli();
-    std::cout << "Average frame time: " << avg_time << "ms" << std::endl;
+    this->print_stats();
 }
\ No newline at end of file
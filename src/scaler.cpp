@@ -0,0 +1,264 @@
+#include "scaler.hpp"
+
+namespace TermVideo
+{
+    Scaler::Scaler()
+    {
+        this->use_count = 0;
+        this->sws_flags = SWS_BILINEAR;
+        this->use_box_filter = false;
+        this->box_key = {};
+    }
+
+    Scaler::~Scaler()
+    {
+        for (CacheEntry &entry : this->cache)
+            sws_freeContext(entry.ctx);
+    }
+
+    bool Scaler::is_valid_algorithm(std::string algorithm)
+    {
+        return algorithm == "fast" || algorithm == "area" || algorithm == "bilinear" ||
+               algorithm == "bicubic" || algorithm == "box";
+    }
+
+    /**
+     * @brief Sets the scaling algorithm used for every following frame
+     * @param algorithm One of fast, area, bilinear, bicubic or box
+     */
+    void Scaler::set_algorithm(std::string algorithm)
+    {
+        this->use_box_filter = (algorithm == "box");
+
+        if (algorithm == "fast")
+            this->sws_flags = SWS_FAST_BILINEAR;
+        else if (algorithm == "area" || algorithm == "box")
+            this->sws_flags = SWS_AREA;
+        else if (algorithm == "bicubic")
+            this->sws_flags = SWS_BICUBIC;
+        else
+            this->sws_flags = SWS_BILINEAR;
+    }
+
+    /**
+     * @brief Scales a frame into the size and pixel format already set on the destination
+     * @param src Decoded frame
+     * @param dst Allocated destination frame, either BGR24 or GRAY8
+     * @return bool Whether the frame was scaled
+     */
+    bool Scaler::scale(const AVFrame *src, AVFrame *dst)
+    {
+        // box filter falls back to swscale's area averaging for unsupported formats
+        if (this->use_box_filter && this->box_scale(src, dst))
+            return true;
+
+        ScalerKey key = {src->width, src->height, src->format, dst->width, dst->height, dst->format};
+        SwsContext *ctx = this->get_context(key);
+        if (ctx == nullptr)
+            return false;
+
+        sws_scale(ctx,
+                  src->data, src->linesize,
+                  0, src->height,
+                  dst->data, dst->linesize);
+        return true;
+    }
+
+    /**
+     * @brief Returns the cached scaler context for the geometry, creating it and evicting
+     *        the least recently used context if needed
+     * @param key Source & destination geometry and pixel formats
+     * @return SwsContext* Scaler context, nullptr if it couldn't be created
+     */
+    SwsContext *Scaler::get_context(const ScalerKey &key)
+    {
+        this->use_count++;
+
+        for (CacheEntry &entry : this->cache)
+        {
+            if (entry.key == key)
+            {
+                entry.last_used = this->use_count;
+                return entry.ctx;
+            }
+        }
+
+        SwsContext *ctx = sws_getContext(
+            key.src_width, key.src_height, static_cast<AVPixelFormat>(key.src_format),
+            key.dst_width, key.dst_height, static_cast<AVPixelFormat>(key.dst_format),
+            this->sws_flags,
+            nullptr, nullptr, nullptr);
+        if (ctx == nullptr)
+            return nullptr;
+
+        if (this->cache.size() >= SCALER_CACHE_SIZE)
+        {
+            auto lru = std::min_element(this->cache.begin(), this->cache.end(),
+                                        [](const CacheEntry &a, const CacheEntry &b)
+                                        { return a.last_used < b.last_used; });
+            sws_freeContext(lru->ctx);
+            this->cache.erase(lru);
+        }
+
+        this->cache.push_back({key, ctx, this->use_count});
+        return ctx;
+    }
+
+    /**
+     * @brief Works out which source columns & rows are averaged into each output cell
+     * @param key Source & destination geometry
+     */
+    void Scaler::box_bounds(const ScalerKey &key)
+    {
+        if (key == this->box_key)
+            return;
+
+        this->box_key = key;
+        this->box_x.resize(key.dst_width);
+        this->box_x_end.resize(key.dst_width);
+        this->box_y.resize(key.dst_height);
+        this->box_y_end.resize(key.dst_height);
+        this->box_sums.resize(key.dst_width * 3);
+
+        // every cell starts inside the source, when upscaling several cells start on the same
+        // pixel and each averages just that 1 pixel
+        for (int x = 0; x < key.dst_width; x++)
+        {
+            this->box_x[x] = static_cast<int>(static_cast<int64_t>(x) * key.src_width / key.dst_width);
+            this->box_x_end[x] = std::max(this->box_x[x] + 1,
+                                          static_cast<int>(static_cast<int64_t>(x + 1) * key.src_width / key.dst_width));
+        }
+        for (int y = 0; y < key.dst_height; y++)
+        {
+            this->box_y[y] = static_cast<int>(static_cast<int64_t>(y) * key.src_height / key.dst_height);
+            this->box_y_end[y] = std::max(this->box_y[y] + 1,
+                                          static_cast<int>(static_cast<int64_t>(y + 1) * key.src_height / key.dst_height));
+        }
+    }
+
+    /**
+     * @brief Averages each block of source pixels straight into its output cell. Supports
+     *        planar YUV sources, converting to BGR once per cell instead of once per pixel
+     * @param src Decoded frame
+     * @param dst Allocated destination frame, either BGR24 or GRAY8
+     * @return bool False if the source format isn't supported
+     */
+    bool Scaler::box_scale(const AVFrame *src, AVFrame *dst)
+    {
+        // chroma subsampling of the supported formats
+        int shift_x, shift_y;
+        bool full_range = false;
+
+        switch (src->format)
+        {
+        case AV_PIX_FMT_YUVJ420P:
+            full_range = true;
+            [[fallthrough]];
+        case AV_PIX_FMT_YUV420P:
+            shift_x = shift_y = 1;
+            break;
+        case AV_PIX_FMT_YUVJ422P:
+            full_range = true;
+            [[fallthrough]];
+        case AV_PIX_FMT_YUV422P:
+            shift_x = 1;
+            shift_y = 0;
+            break;
+        case AV_PIX_FMT_YUVJ444P:
+            full_range = true;
+            [[fallthrough]];
+        case AV_PIX_FMT_YUV444P:
+            shift_x = shift_y = 0;
+            break;
+        default:
+            return false;
+        }
+
+        bool grayscale = (dst->format == AV_PIX_FMT_GRAY8);
+        if (!grayscale && dst->format != AV_PIX_FMT_BGR24)
+            return false;
+
+        this->box_bounds({src->width, src->height, src->format, dst->width, dst->height, dst->format});
+
+        const int channels = grayscale ? 1 : 3;
+        std::vector<uint32_t> &sums = this->box_sums;
+
+        for (int y = 0; y < dst->height; y++)
+        {
+            const int y0 = this->box_y[y], y1 = this->box_y_end[y];
+            const int cy0 = y0 >> shift_y, cy1 = std::max(cy0 + 1, (y1 + (1 << shift_y) - 1) >> shift_y);
+            std::fill(sums.begin(), sums.end(), 0);
+
+            // luma, summed row by row so the source is read sequentially
+            for (int sy = y0; sy < y1; sy++)
+            {
+                const uchar *luma = src->data[0] + sy * src->linesize[0];
+                for (int x = 0; x < dst->width; x++)
+                {
+                    uint32_t sum = 0;
+                    for (int sx = this->box_x[x]; sx < this->box_x_end[x]; sx++)
+                        sum += luma[sx];
+                    sums[x * 3] += sum;
+                }
+            }
+
+            // chroma, skipped entirely for grayscale output
+            for (int sy = cy0; !grayscale && sy < cy1; sy++)
+            {
+                const uchar *cb = src->data[1] + sy * src->linesize[1];
+                const uchar *cr = src->data[2] + sy * src->linesize[2];
+                for (int x = 0; x < dst->width; x++)
+                {
+                    const int cx0 = this->box_x[x] >> shift_x,
+                              cx1 = std::max(cx0 + 1, (this->box_x_end[x] + (1 << shift_x) - 1) >> shift_x);
+                    for (int sx = cx0; sx < cx1; sx++)
+                    {
+                        sums[x * 3 + 1] += cb[sx];
+                        sums[x * 3 + 2] += cr[sx];
+                    }
+                }
+            }
+
+            uchar *out = dst->data[0] + y * dst->linesize[0];
+            for (int x = 0; x < dst->width; x++)
+            {
+                const int luma_count = (y1 - y0) * (this->box_x_end[x] - this->box_x[x]);
+                int luma = sums[x * 3] / luma_count;
+
+                // expand limited range luma (16-235) to full range
+                if (!full_range)
+                    luma = (luma - 16) * 255 / 219;
+
+                if (grayscale)
+                {
+                    out[x * channels] = static_cast<uchar>(std::clamp(luma, 0, 255));
+                    continue;
+                }
+
+                const int cx0 = this->box_x[x] >> shift_x,
+                          cx1 = std::max(cx0 + 1, (this->box_x_end[x] + (1 << shift_x) - 1) >> shift_x);
+                const int chroma_count = (cy1 - cy0) * (cx1 - cx0);
+                int cb = static_cast<int>(sums[x * 3 + 1] / chroma_count) - 128,
+                    cr = static_cast<int>(sums[x * 3 + 2] / chroma_count) - 128;
+
+                // limited range chroma spans 224 values instead of 255
+                if (!full_range)
+                {
+                    cb = cb * 255 / 224;
+                    cr = cr * 255 / 224;
+                }
+
+                // BT.601 in 16.16 fixed point
+                int r = luma + ((91881 * cr) >> 16),
+                    g = luma - ((22554 * cb + 46802 * cr) >> 16),
+                    b = luma + ((116130 * cb) >> 16);
+
+                out[x * channels] = static_cast<uchar>(std::clamp(b, 0, 255));
+                out[x * channels + 1] = static_cast<uchar>(std::clamp(g, 0, 255));
+                out[x * channels + 2] = static_cast<uchar>(std::clamp(r, 0, 255));
+            }
+        }
+
+        return true;
+    }
+}
\ No newline at end of file
@@ -41,9 +41,24 @@ void TermVideo::get_terminal_size(int &width, int &height, bool &term_resized)
     height = new_height;
 }
 
-void TermVideo::init_terminal_col(bool print_colour)
+void TermVideo::init_terminal_col(bool print_colour, int colour_depth)
+{
+    std::cout << get_terminal_col(print_colour, colour_depth);
+}
+
+/**
+ * @brief Escape codes setting the default colours frames are drawn over
+ *
+ * @param print_colour Flag whether frames are coloured
+ * @param colour_depth Colours used by the frames, 24 (RGB), 256 or 16
+ * @return std::string Foreground & background escape codes
+ */
+std::string TermVideo::get_terminal_col(bool print_colour, int colour_depth)
 {
     // white bg / black fg for grayscale, inverse for colour printing
-    std::cout << ((print_colour) ? "\033[38;2;255;255;255m" : "\033[38;2;0;0;0m");
-    std::cout << ((print_colour) ? "\033[48;2;0;0;0m" : "\033[48;2;255;255;255m");
+    if (colour_depth == 24)
+        return print_colour ? "\033[38;2;255;255;255m\033[48;2;0;0;0m" : "\033[38;2;0;0;0m\033[48;2;255;255;255m";
+
+    // terminals without RGB support only get the standard colours
+    return print_colour ? "\033[97m\033[40m" : "\033[30m\033[107m";
 }
\ No newline at end of file
@@ -0,0 +1,191 @@
+#include "terminal_writer.hpp"
+
+TermVideo::TerminalWriter::TerminalWriter()
+{
+    this->fd = -1;
+    this->sync_supported = false;
+    this->last_write_time_milli = 0;
+    this->last_write_bytes = 0;
+}
+
+/**
+ * @brief Picks the file descriptor frames are written to and asks the terminal whether
+ *        it supports synchronized output. Must run before ncurses changes terminal modes
+ */
+void TermVideo::TerminalWriter::open()
+{
+#if defined(__linux__)
+    this->fd = fileno(stdout);
+
+    // redirected output has no terminal to answer the query
+    this->sync_supported = isatty(this->fd) && this->query_sync_support();
+#endif
+}
+
+/**
+ * @brief Writes a frame, retrying until every byte is written. Anything still buffered
+ *        by stdio is flushed first so it isn't written after the frame
+ *
+ * @param frame Bytes of the frame
+ * @return bool Whether the whole frame was written
+ */
+bool TermVideo::TerminalWriter::write_frame(const std::string &frame)
+{
+    return this->write_frame(frame.data(), frame.length());
+}
+
+/**
+ * @brief Writes the bytes of one or more frames, such as frames mapped from a file
+ *
+ * @param frame Bytes of the frames
+ * @param length Number of bytes
+ * @return bool Whether every byte was written
+ */
+bool TermVideo::TerminalWriter::write_frame(const char *frame, size_t length)
+{
+    auto start_time = std::chrono::steady_clock::now();
+    fflush(stdout);
+
+#if defined(__linux__)
+    struct iovec parts[3] = {
+        {const_cast<char *>(SYNC_OUTPUT_BEGIN), strlen(SYNC_OUTPUT_BEGIN)},
+        {const_cast<char *>(frame), length},
+        {const_cast<char *>(SYNC_OUTPUT_END), strlen(SYNC_OUTPUT_END)}};
+
+    struct iovec *pending = this->sync_supported ? parts : parts + 1;
+    int pending_count = this->sync_supported ? 3 : 1;
+    size_t written_total = 0;
+
+    while (pending_count > 0)
+    {
+        ssize_t written = writev(this->fd, pending, pending_count);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            // non-blocking terminals need to drain before the rest fits
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                struct pollfd writable = {this->fd, POLLOUT, 0};
+                poll(&writable, 1, -1);
+                continue;
+            }
+
+            return false;
+        }
+
+        // skip past the parts that were written, then into a partially written part
+        written_total += written;
+        while (pending_count > 0 && static_cast<size_t>(written) >= pending->iov_len)
+        {
+            written -= pending->iov_len;
+            pending++;
+            pending_count--;
+        }
+        if (pending_count > 0)
+        {
+            pending->iov_base = static_cast<char *>(pending->iov_base) + written;
+            pending->iov_len -= written;
+        }
+    }
+
+    this->last_write_bytes = written_total;
+#else
+    fwrite(frame, length, 1, stdout);
+    fflush(stdout);
+    this->last_write_bytes = length;
+#endif
+
+    auto end_time = std::chrono::steady_clock::now();
+    this->last_write_time_milli = std::chrono::duration<double, std::milli>(end_time - start_time).count();
+    return true;
+}
+
+bool TermVideo::TerminalWriter::is_sync_supported()
+{
+    return this->sync_supported;
+}
+
+double TermVideo::TerminalWriter::get_last_write_time_milli()
+{
+    return this->last_write_time_milli;
+}
+
+/**
+ * @brief Bytes written for the last frame, including the synchronized output sequences
+ */
+size_t TermVideo::TerminalWriter::get_last_write_bytes()
+{
+    return this->last_write_bytes;
+}
+
+#if defined(__linux__)
+/**
+ * @brief Asks the terminal for the state of synchronized output with DECRQM, followed by
+ *        a device attributes request every terminal answers. Once that answer arrives, a
+ *        terminal that hasn't answered the first request doesn't support it
+ *
+ * @return bool Whether synchronized output is supported
+ */
+bool TermVideo::TerminalWriter::query_sync_support()
+{
+    int tty = ::open("/dev/tty", O_RDWR | O_NOCTTY);
+    if (tty < 0)
+        return false;
+
+    // answers are read without waiting for enter & without echoing them
+    struct termios saved, raw;
+    if (tcgetattr(tty, &saved) < 0)
+    {
+        close(tty);
+        return false;
+    }
+    raw = saved;
+    raw.c_lflag &= ~(ICANON | ECHO);
+    raw.c_cc[VMIN] = 0;
+    raw.c_cc[VTIME] = 0;
+    tcsetattr(tty, TCSANOW, &raw);
+
+    const char query[] = "\033[?2026$p\033[c";
+    bool supported = false;
+
+    if (::write(tty, query, sizeof(query) - 1) == static_cast<ssize_t>(sizeof(query) - 1))
+    {
+        std::string reply;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(SYNC_QUERY_TIMEOUT_MS);
+
+        while (true)
+        {
+            int remaining = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                                 deadline - std::chrono::steady_clock::now())
+                                                 .count());
+            struct pollfd readable = {tty, POLLIN, 0};
+            if (remaining <= 0 || poll(&readable, 1, remaining) <= 0)
+                break;
+
+            char buffer[64];
+            ssize_t length = read(tty, buffer, sizeof(buffer));
+            if (length <= 0)
+                break;
+            reply.append(buffer, length);
+
+            // DECRQM answers 1 or 2 when the mode is recognised and can be changed
+            size_t mode = reply.find("\033[?2026;");
+            if (mode != std::string::npos && reply.find("$y", mode) != std::string::npos)
+            {
+                char state = reply[mode + 8];
+                supported = (state == '1' || state == '2');
+            }
+
+            // answers come back in order, so the device attributes answer ending in 'c' is last
+            if (reply.back() == 'c')
+                break;
+        }
+    }
+
+    tcsetattr(tty, TCSANOW, &saved);
+    close(tty);
+    return supported;
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,249 @@
+#include "tvid.hpp"
+
+namespace TermVideo
+{
+    TvidWriter::TvidWriter()
+    {
+        this->file = nullptr;
+        this->header = {};
+        this->offset = 0;
+        this->keyframes = 0;
+    }
+
+    TvidWriter::~TvidWriter()
+    {
+        if (this->file != nullptr)
+            fclose(this->file);
+    }
+
+    /**
+     * @brief Creates a .tvid file, leaving room for the header
+     *
+     * @param path Path of the file
+     * @param header Grid size, codec & output settings of the frames, the rest is filled in
+     * @return std::string Error string
+     */
+    std::string TvidWriter::open(const std::string &path, const TvidHeader &header)
+    {
+        this->file = fopen(path.c_str(), "wb");
+        if (this->file == nullptr)
+            return "Could not create " + path;
+
+        this->header = header;
+        memcpy(this->header.magic, TVID_MAGIC, sizeof(this->header.magic));
+        this->header.version = TVID_VERSION;
+        this->header.dither[sizeof(this->header.dither) - 1] = '\0';
+
+        // rewritten with the frame count & index offset on closing
+        this->offset = sizeof(TvidHeader);
+        if (fwrite(&this->header, sizeof(TvidHeader), 1, this->file) != 1)
+            return "Could not write to " + path;
+
+        return "";
+    }
+
+    /**
+     * @brief Appends a frame's encoded bytes
+     *
+     * @param frame Bytes written to the terminal for the frame
+     * @param pts_ms Timestamp of the frame
+     * @param keyframe Flag whether the frame redraws every cell
+     * @return bool Whether the frame was written
+     */
+    bool TvidWriter::add_frame(const std::string &frame, double pts_ms, bool keyframe)
+    {
+        if (!frame.empty() && fwrite(frame.data(), frame.length(), 1, this->file) != 1)
+            return false;
+
+        this->index.push_back({this->offset, static_cast<uint32_t>(frame.length()), keyframe ? 1u : 0u, pts_ms});
+        this->offset += frame.length();
+        this->keyframes += keyframe;
+        return true;
+    }
+
+    /**
+     * @brief Writes the index after the frames and fills in the header
+     *
+     * @param frametime_ns Time between frames
+     * @return std::string Error string
+     */
+    std::string TvidWriter::close(uint64_t frametime_ns)
+    {
+        // the index is aligned so it can be read in place from the mapped file
+        const char padding[8] = {};
+        const uint64_t padding_length = (8 - this->offset % 8) % 8;
+
+        this->header.frametime_ns = frametime_ns;
+        this->header.frame_count = this->index.size();
+        this->header.index_offset = this->offset + padding_length;
+
+        bool written = fwrite(padding, 1, padding_length, this->file) == padding_length &&
+                       fwrite(this->index.data(), sizeof(TvidIndexEntry), this->index.size(), this->file) == this->index.size() &&
+                       fseek(this->file, 0, SEEK_SET) == 0 &&
+                       fwrite(&this->header, sizeof(TvidHeader), 1, this->file) == 1;
+
+        written = (fclose(this->file) == 0) && written;
+        this->file = nullptr;
+
+        return written ? "" : "Could not finish writing the exported file";
+    }
+
+    uint64_t TvidWriter::get_frame_count()
+    {
+        return this->index.size();
+    }
+
+    uint64_t TvidWriter::get_keyframe_count()
+    {
+        return this->keyframes;
+    }
+
+    uint64_t TvidWriter::get_frame_bytes()
+    {
+        return this->offset - sizeof(TvidHeader);
+    }
+
+    TvidReader::TvidReader()
+    {
+        this->data = nullptr;
+        this->size = 0;
+        this->header = nullptr;
+        this->index = nullptr;
+    }
+
+    TvidReader::~TvidReader()
+    {
+#if defined(__linux__)
+        if (this->data != nullptr)
+            munmap(const_cast<char *>(this->data), this->size);
+#endif
+    }
+
+    /**
+     * @brief Maps a .tvid file into memory and checks its header & index
+     *
+     * @param path Path of the file
+     * @return std::string Error string
+     */
+    std::string TvidReader::open(const std::string &path)
+    {
+#if defined(__linux__)
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return "Could not open " + path;
+
+        struct stat file_stat;
+        if (fstat(fd, &file_stat) < 0 || file_stat.st_size < static_cast<off_t>(sizeof(TvidHeader)))
+        {
+            ::close(fd);
+            return path + " is not a .tvid file";
+        }
+
+        this->size = file_stat.st_size;
+        void *mapping = mmap(nullptr, this->size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED)
+            return "Could not map " + path;
+
+        // frames are read front to back
+        madvise(mapping, this->size, MADV_SEQUENTIAL);
+        this->data = static_cast<const char *>(mapping);
+#else
+        FILE *file = fopen(path.c_str(), "rb");
+        if (file == nullptr)
+            return "Could not open " + path;
+
+        fseek(file, 0, SEEK_END);
+        this->contents.resize(std::max<long>(ftell(file), 0));
+        fseek(file, 0, SEEK_SET);
+        size_t read = fread(this->contents.data(), 1, this->contents.size(), file);
+        fclose(file);
+
+        if (read != this->contents.size() || read < sizeof(TvidHeader))
+            return path + " is not a .tvid file";
+
+        this->data = this->contents.data();
+        this->size = this->contents.size();
+#endif
+
+        this->header = reinterpret_cast<const TvidHeader *>(this->data);
+        if (memcmp(this->header->magic, TVID_MAGIC, sizeof(this->header->magic)) != 0)
+            return path + " is not a .tvid file";
+        if (this->header->version != TVID_VERSION)
+            return path + " is version " + std::to_string(this->header->version) + ", expected " + std::to_string(TVID_VERSION);
+        if (this->header->codec != TVID_CODEC_TERMINAL && this->header->codec != TVID_CODEC_CELLS)
+            return path + " uses an unknown codec";
+
+        // an export that was cut short has no index
+        const uint64_t index_offset = this->header->index_offset;
+        if (this->header->frame_count == 0 || index_offset < sizeof(TvidHeader) || index_offset % 8 != 0 ||
+            index_offset > this->size || (this->size - index_offset) / sizeof(TvidIndexEntry) < this->header->frame_count)
+            return path + " has no frames or its index is incomplete";
+
+        this->index = reinterpret_cast<const TvidIndexEntry *>(this->data + index_offset);
+        for (uint64_t i = 0; i < this->header->frame_count; i++)
+        {
+            // compared without adding, so a huge offset can't wrap around
+            const TvidIndexEntry &entry = this->index[i];
+            if (entry.offset < sizeof(TvidHeader) || entry.offset > index_offset || entry.length > index_offset - entry.offset)
+                return path + " has a frame outside of the file";
+
+            // ranges of frames are read in one go & found by binary search of their times
+            if (i > 0 && entry.offset != this->index[i - 1].offset + this->index[i - 1].length)
+                return path + " has frames that aren't stored back to back";
+            if (std::isnan(entry.pts_ms) || (i > 0 && entry.pts_ms < this->index[i - 1].pts_ms))
+                return path + " has frames out of order";
+        }
+
+        return "";
+    }
+
+    const TvidHeader &TvidReader::get_header()
+    {
+        return *this->header;
+    }
+
+    uint64_t TvidReader::get_frame_count()
+    {
+        return this->header->frame_count;
+    }
+
+    const TvidIndexEntry &TvidReader::get_entry(uint64_t frame)
+    {
+        return this->index[frame];
+    }
+
+    const char *TvidReader::get_frame_data(uint64_t frame)
+    {
+        return this->data + this->index[frame].offset;
+    }
+
+    /**
+     * @brief Finds the last frame shown at or before a time, by binary search of the index
+     *
+     * @param pts_ms Time in milliseconds
+     * @return uint64_t Index of the frame, the first frame for times before it
+     */
+    uint64_t TvidReader::find_frame(double pts_ms)
+    {
+        const TvidIndexEntry *end = this->index + this->header->frame_count;
+        const TvidIndexEntry *after = std::upper_bound(this->index, end, pts_ms,
+                                                       [](double pts, const TvidIndexEntry &entry)
+                                                       { return pts < entry.pts_ms; });
+
+        return (after == this->index) ? 0 : static_cast<uint64_t>(after - this->index) - 1;
+    }
+
+    /**
+     * @brief Finds the keyframe a frame's deltas start from
+     *
+     * @param frame Index of the frame
+     * @return uint64_t Index of the keyframe at or before the frame
+     */
+    uint64_t TvidReader::find_keyframe(uint64_t frame)
+    {
+        while (frame > 0 && !this->index[frame].keyframe)
+            frame--;
+        return frame;
+    }
+}
\ No newline at end of file
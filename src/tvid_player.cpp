@@ -0,0 +1,184 @@
+#include "tvid_player.hpp"
+
+namespace TermVideo
+{
+    /**
+     * @brief Construct a new TvidPlayer object
+     *
+     * @param info Shared with the keyboard listener, which requests seeks through it
+     * @param opts Options, the .tvid file is the playback path
+     */
+    TvidPlayer::TvidPlayer(MediaInfo *info, Options opts)
+    {
+        this->info = info;
+        this->info->v_clock_ms = 0;
+        this->info->a_clock_ms = 0;
+        this->info->seek_step_ms = opts.seek_step_ms;
+        this->filename = opts.playback_path;
+        this->disable_frame_sync = opts.disable_frame_sync;
+        this->decode_cells = false;
+    }
+
+    /**
+     * @brief Maps the file and sets the terminal up for the colours it was exported with
+     * @return std::string Error string
+     */
+    std::string TvidPlayer::init_player()
+    {
+        std::string res = this->reader.open(this->filename);
+        if (res.length() > 0)
+            return res;
+
+        const TvidHeader &header = this->reader.get_header();
+        int width = 0, height = 0;
+        bool term_resized = false;
+        get_terminal_size(width, height, term_resized);
+
+        // frames rely on the terminal wrapping rows at the exported width
+        if (width != static_cast<int>(header.width) || height < static_cast<int>(header.height))
+            return "Exported at " + std::to_string(header.width) + "x" + std::to_string(header.height) +
+                   ", the terminal is " + std::to_string(width) + "x" + std::to_string(height);
+
+        if (header.codec == TVID_CODEC_CELLS)
+        {
+            const bool print_colour = header.flags & TVID_FLAG_COLOUR, use_background = header.flags & TVID_FLAG_BACKGROUND;
+            const uchar col_threshold = static_cast<uchar>(header.col_threshold);
+
+            this->codec = CellCodec(print_colour, use_background, col_threshold);
+            this->encoder = FrameEncoder(print_colour, col_threshold, true, header.colour_depth, use_background,
+                                         header.colour_budget, std::string(header.dither, strnlen(header.dither, sizeof(header.dither))));
+            this->decode_cells = true;
+        }
+
+        set_terminal_title(this->filename);
+        hide_terminal_cursor();
+        init_terminal_col(header.flags & TVID_FLAG_COLOUR, header.colour_depth);
+        this->writer.open();
+        return "";
+    }
+
+    /**
+     * @brief Writes each frame when it's due. Frames that are due together are written in a
+     *        single call, since deltas can't be skipped on their own
+     */
+    void TvidPlayer::play()
+    {
+        const uint64_t frame_count = this->reader.get_frame_count();
+        auto start_time = std::chrono::steady_clock::now();
+        double start_pts_ms = this->reader.get_entry(0).pts_ms;
+
+        for (uint64_t frame = 0; frame < frame_count;)
+        {
+            if (this->info->seek.req)
+            {
+                frame = this->seek_to(this->info->seek.pos);
+                this->info->seek.req = false;
+
+                start_time = std::chrono::steady_clock::now();
+                start_pts_ms = this->reader.get_entry(frame).pts_ms;
+                this->info->v_clock_ms = start_pts_ms;
+                frame++;
+                continue;
+            }
+
+            auto due_time = start_time + std::chrono::duration<double, std::milli>(this->reader.get_entry(frame).pts_ms - start_pts_ms);
+            if (!this->disable_frame_sync)
+                std::this_thread::sleep_until(due_time);
+
+            // every frame that's already due goes out with this one
+            double elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+            uint64_t last = frame;
+            while (!this->disable_frame_sync && last + 1 < frame_count &&
+                   this->reader.get_entry(last + 1).pts_ms - start_pts_ms <= elapsed_ms)
+                last++;
+
+            for (uint64_t late = frame; late < last; late++)
+                this->perf_checker.add_late_frame();
+
+            if (!this->write_frames(frame, last))
+                break;
+
+            this->info->v_clock_ms = this->reader.get_entry(last).pts_ms;
+            frame = last + 1;
+        }
+
+        std::cout << "Played " << frame_count << " frames from " << this->filename << std::endl;
+        std::cout << "Late frames: " << this->perf_checker.get_late_frames()
+                  << ", average output: " << this->perf_checker.get_avg_frame_bytes() << " bytes/write" << std::endl;
+        std::cout << "Average write: " << this->perf_checker.get_avg_write_time_milli() << "ms"
+                  << ", longest write: " << this->perf_checker.get_max_write_time_milli() << "ms"
+                  << ", synchronized output: " << (this->writer.is_sync_supported() ? "on" : "off") << std::endl;
+    }
+
+    /**
+     * @brief Jumps to the frame shown at a time, replaying it from the keyframe before it
+     *        in a single write
+     *
+     * @param pts_ms Time to seek to
+     * @return uint64_t Index of the frame now on screen
+     */
+    uint64_t TvidPlayer::seek_to(double pts_ms)
+    {
+        uint64_t frame = this->reader.find_frame(std::max(pts_ms, 0.0));
+        if (this->decode_cells)
+            this->encoder.force_full_repaint();
+        this->write_frames(this->reader.find_keyframe(frame), frame);
+        return frame;
+    }
+
+    /**
+     * @brief Writes a range of frames, which are stored back to back in the file
+     *
+     * @param first Index of the first frame
+     * @param last Index of the last frame, inclusive
+     * @return bool Whether the frames were written
+     */
+    bool TvidPlayer::write_frames(uint64_t first, uint64_t last)
+    {
+        if (this->decode_cells)
+            return this->write_cell_frames(first, last);
+
+        const TvidIndexEntry &last_entry = this->reader.get_entry(last);
+        const char *data = this->reader.get_frame_data(first);
+        size_t length = last_entry.offset + last_entry.length - this->reader.get_entry(first).offset;
+
+        if (!this->writer.write_frame(data, length))
+            return false;
+
+        this->perf_checker.add_frame_bytes(this->writer.get_last_write_bytes());
+        this->perf_checker.add_write_time(this->writer.get_last_write_time_milli());
+        return true;
+    }
+
+    /**
+     * @brief Decodes a range of compressed frames and writes the last one, encoded against
+     *        what's on screen
+     *
+     * @param first Index of the first frame
+     * @param last Index of the last frame, inclusive
+     * @return bool Whether the frames were decoded & written
+     */
+    bool TvidPlayer::write_cell_frames(uint64_t first, uint64_t last)
+    {
+        const TvidHeader &header = this->reader.get_header();
+        for (uint64_t frame = first; frame <= last; frame++)
+        {
+            if (!this->codec.decode(this->reader.get_frame_data(frame), this->reader.get_entry(frame).length,
+                                    header.width, header.height))
+            {
+                std::cerr << "Frame " << frame << " of " << this->filename << " is corrupt" << std::endl;
+                return false;
+            }
+        }
+
+        // the encoder fills in palette indices, so it works on a copy
+        this->cells = this->codec.get_cells();
+        this->encoder.encode(this->cells, header.width, header.height, this->output);
+        if (!this->writer.write_frame(this->output))
+            return false;
+
+        this->perf_checker.add_frame_bytes(this->writer.get_last_write_bytes());
+        this->perf_checker.add_write_time(this->writer.get_last_write_time_milli());
+        return true;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,113 @@
+#include "worker_pool.hpp"
+
+namespace TermVideo
+{
+    /**
+     * @brief Construct a new WorkerPool object, starting its threads
+     *
+     * @param thread_count Threads running tasks including the caller of run, at least 1
+     */
+    WorkerPool::WorkerPool(int thread_count)
+    {
+        this->task = nullptr;
+        this->task_context = nullptr;
+        this->task_count = 0;
+        this->next_task = 0;
+        this->busy_workers = 0;
+        this->job = 0;
+        this->stopping = false;
+
+        for (int i = 1; i < thread_count; i++)
+            this->threads.emplace_back(&WorkerPool::work, this);
+    }
+
+    WorkerPool::~WorkerPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->stopping = true;
+        }
+        this->start_cond.notify_all();
+
+        for (std::thread &thread : this->threads)
+            thread.join();
+    }
+
+    /**
+     * @brief Runs a job given as a function & the context it's called with
+     *
+     * @param task_count Number of tasks
+     * @param task Function running a single task, given the context & the index of the task
+     * @param context Callable the job was started with
+     */
+    void WorkerPool::run_job(int task_count, void (*task)(void *, int), void *context)
+    {
+        // waking the workers costs more than a single task
+        if (this->threads.empty() || task_count <= 1)
+        {
+            for (int i = 0; i < task_count; i++)
+                task(context, i);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->task = task;
+            this->task_context = context;
+            this->task_count = task_count;
+            this->next_task = 0;
+            this->busy_workers = static_cast<int>(this->threads.size());
+            this->job++;
+        }
+        this->start_cond.notify_all();
+
+        this->run_tasks();
+
+        std::unique_lock<std::mutex> lock(this->mutex);
+        this->done_cond.wait(lock, [this]
+                             { return this->busy_workers == 0; });
+        this->task = nullptr;
+        this->task_context = nullptr;
+    }
+
+    int WorkerPool::get_thread_count()
+    {
+        return static_cast<int>(this->threads.size()) + 1;
+    }
+
+    /**
+     * @brief Loop of each worker thread, waiting for a job and taking its tasks
+     */
+    void WorkerPool::work()
+    {
+        uint64_t last_job = 0;
+
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(this->mutex);
+                this->start_cond.wait(lock, [this, last_job]
+                                      { return this->stopping || this->job != last_job; });
+                if (this->stopping)
+                    return;
+
+                last_job = this->job;
+            }
+
+            this->run_tasks();
+
+            std::lock_guard<std::mutex> lock(this->mutex);
+            if (--this->busy_workers == 0)
+                this->done_cond.notify_one();
+        }
+    }
+
+    /**
+     * @brief Takes tasks of the current job until none are left
+     */
+    void WorkerPool::run_tasks()
+    {
+        for (int i = this->next_task++; i < this->task_count; i = this->next_task++)
+            this->task(this->task_context, i);
+    }
+}
\ No newline at end of file